@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "puzzle_solver.h"
+
+// 按棋盘尺寸在编译时选择的位棋盘：N x N个格子，第 (row * N + col) 位表示单元格 (row, col)
+// 格子数不超过64时用uint64_t，不超过128时用unsigned __int128（编译器支持时），
+// 否则用多字位集MultiWordMask；各尺寸的搜索循环分别实例化，不在运行时判断尺寸
+
+// 多字位集：所有运算都对固定个数的字逐个展开，比较和判空没有依赖数据的分支
+template <int Words>
+struct MultiWordMask {
+    uint64_t words[Words] = {};
+
+    constexpr MultiWordMask operator&(const MultiWordMask& other) const {
+        MultiWordMask result;
+        for (int i = 0; i < Words; i++) result.words[i] = words[i] & other.words[i];
+        return result;
+    }
+    constexpr MultiWordMask operator|(const MultiWordMask& other) const {
+        MultiWordMask result;
+        for (int i = 0; i < Words; i++) result.words[i] = words[i] | other.words[i];
+        return result;
+    }
+    constexpr MultiWordMask operator^(const MultiWordMask& other) const {
+        MultiWordMask result;
+        for (int i = 0; i < Words; i++) result.words[i] = words[i] ^ other.words[i];
+        return result;
+    }
+    constexpr MultiWordMask operator~() const {
+        MultiWordMask result;
+        for (int i = 0; i < Words; i++) result.words[i] = ~words[i];
+        return result;
+    }
+    // 移位量必须在1..63之间（棋盘上只需要移一列或一行）
+    constexpr MultiWordMask operator<<(int shift) const {
+        MultiWordMask result;
+        for (int i = 0; i < Words; i++) {
+            result.words[i] = words[i] << shift;
+            if (i > 0) result.words[i] |= words[i - 1] >> (64 - shift);
+        }
+        return result;
+    }
+    constexpr MultiWordMask operator>>(int shift) const {
+        MultiWordMask result;
+        for (int i = 0; i < Words; i++) {
+            result.words[i] = words[i] >> shift;
+            if (i + 1 < Words) result.words[i] |= words[i + 1] << (64 - shift);
+        }
+        return result;
+    }
+    constexpr bool operator==(const MultiWordMask& other) const {
+        uint64_t difference = 0;
+        for (int i = 0; i < Words; i++) difference |= words[i] ^ other.words[i];
+        return difference == 0;
+    }
+    constexpr bool operator!=(const MultiWordMask& other) const { return !(*this == other); }
+};
+
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 Mask128;
+#else
+typedef MultiWordMask<2> Mask128;
+#endif
+
+// 掩码类型相关的基本运算；整数类型用内建运算，多字位集逐字处理
+template <typename Mask>
+struct MaskOps {
+    static constexpr Mask bit(int index) { return (Mask)1 << index; }
+    static constexpr bool empty(Mask mask) { return mask == 0; }
+    static int lowestBit(Mask mask) {
+        uint64_t low = (uint64_t)mask;
+        if (sizeof(Mask) <= sizeof(uint64_t) || low) return lowestBitIndex(low);
+        return 64 + lowestBitIndex((uint64_t)(mask >> 32 >> 32));
+    }
+    static int count(Mask mask) {
+        int result = popCount((uint64_t)mask);
+        if (sizeof(Mask) > sizeof(uint64_t)) result += popCount((uint64_t)(mask >> 32 >> 32));
+        return result;
+    }
+};
+
+template <int Words>
+struct MaskOps<MultiWordMask<Words>> {
+    typedef MultiWordMask<Words> Mask;
+    static constexpr Mask bit(int index) {
+        Mask mask;
+        mask.words[index / 64] = 1ULL << (index % 64);
+        return mask;
+    }
+    static constexpr bool empty(const Mask& mask) { return mask == Mask(); }
+    static int lowestBit(const Mask& mask) {
+        for (int i = 0; i < Words; i++) {
+            if (mask.words[i]) return i * 64 + lowestBitIndex(mask.words[i]);
+        }
+        return -1;
+    }
+    static int count(const Mask& mask) {
+        int result = 0;
+        for (int i = 0; i < Words; i++) result += popCount(mask.words[i]);
+        return result;
+    }
+};
+
+template <int Cells>
+struct BoardStorage {
+    typedef typename std::conditional<(Cells <= 64), uint64_t,
+        typename std::conditional<(Cells <= 128), Mask128, MultiWordMask<(Cells + 63) / 64>>::type>::type Mask;
+};
+
+// N x N棋盘的几何：格子掩码、整列掩码、形状掩码和洪水填充，均可在编译期求值（洪水填充除外）
+template <int N>
+struct Board {
+    static_assert(N >= 2 && N <= 16, "board size out of range");
+
+    static constexpr int SIZE = N;
+    static constexpr int CELLS = N * N;
+    typedef typename BoardStorage<CELLS>::Mask Mask;
+    typedef MaskOps<Mask> Ops;
+
+    static constexpr Mask cellBit(int row, int col) { return Ops::bit(row * N + col); }
+
+    static constexpr Mask full() {
+        Mask mask = Mask();
+        for (int cell = 0; cell < CELLS; cell++) mask = mask | Ops::bit(cell);
+        return mask;
+    }
+
+    static constexpr Mask column(int col) {
+        Mask mask = Mask();
+        for (int row = 0; row < N; row++) mask = mask | cellBit(row, col);
+        return mask;
+    }
+
+    // 形状（相对基准点的格子偏移）放在基准点(row, col)时占用的格子；有格子超出棋盘时返回false
+    static constexpr bool shapeMask(const std::pair<int, int>* cells, int cellCount, int row, int col, Mask& mask) {
+        mask = Mask();
+        for (int k = 0; k < cellCount; k++) {
+            int r = row + cells[k].first;
+            int c = col + cells[k].second;
+            if (r < 0 || r >= N || c < 0 || c >= N) return false;
+            mask = mask | cellBit(r, c);
+        }
+        return true;
+    }
+
+    // 从seed出发，在within范围内做四连通洪水填充（左右移位时去掉跨行的位）
+    static Mask floodFill(Mask seed, Mask within) {
+        constexpr Mask notFirstColumn = ~column(0);
+        constexpr Mask notLastColumn = ~column(N - 1);
+        Mask region = seed & within;
+        while (true) {
+            Mask grown = region | (region << N) | (region >> N) | ((region << 1) & notFirstColumn) |
+                         ((region >> 1) & notLastColumn);
+            grown = grown & within;
+            if (grown == region) return region;
+            region = grown;
+        }
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+
+// 位棋盘搜索的共用辅助函数：按棋盘几何Board<N>（及其掩码运算MaskOps）模板化，
+// 8x8的BitboardSolver和ExactCoverSolver用Board<BOARD_SIZE>实例化（uint64_t，与手写的位运算相同），
+// BoardSolver<N>用各自的尺寸实例化
+
+// 剩余图块能凑出的面积：第i位为1表示剩余图块中某个子多重集的总面积为i（只需要小于棋盘格子数的面积）
+// 掩码本身有CELLS位，正好可以用作这个位集；移位量为图块的格子数（1..63）
+template <typename Geometry>
+typename Geometry::Mask reachableAreas(const std::vector<int>& cellCounts, const std::vector<int>& remaining) {
+    typedef typename Geometry::Mask Mask;
+    typedef typename Geometry::Ops Ops;
+    constexpr Mask full = Geometry::full();
+    Mask areas = Ops::bit(0);
+    for (size_t t = 0; t < remaining.size() && areas != full; t++) {
+        for (int k = 0; k < remaining[t]; k++) {
+            Mask next = (areas | (areas << cellCounts[t])) & full;
+            if (next == areas) break;
+            areas = next;
+        }
+    }
+    return areas;
+}
+
+// 每个连通的空区域都必须由剩余图块中的一部分正好铺满：检查每个区域的面积是否为剩余图块大小的某个子集和
+// （必要条件；返回false则一定无解）
+template <typename Geometry>
+bool regionsFeasible(typename Geometry::Mask occupied, const std::vector<int>& cellCounts,
+                     const std::vector<int>& remaining) {
+    typedef typename Geometry::Mask Mask;
+    typedef typename Geometry::Ops Ops;
+    constexpr Mask full = Geometry::full();
+    Mask empty = ~occupied & full;
+    Mask region = Geometry::floodFill(Ops::bit(Ops::lowestBit(empty)), empty);
+    // 只有一个空区域：它的面积就是剩余图块的总面积（根节点已校验）
+    if (region == empty) return true;
+
+    // 此时每个区域都小于棋盘的格子数，面积位集不会溢出
+    Mask areas = reachableAreas<Geometry>(cellCounts, remaining);
+    while (true) {
+        if (Ops::empty(areas & Ops::bit(Ops::count(region)))) return false;
+        empty = empty & ~region;
+        if (Ops::empty(empty)) return true;
+        region = Geometry::floodFill(Ops::bit(Ops::lowestBit(empty)), empty);
+    }
+}
+
+// 把前depth层的放置画到board上（N x N，单元格为pieceId，0为空）
+// placed(d)返回第d层放置的{pieceId, 掩码}
+template <typename Geometry, typename Placed>
+void buildSolutionBoard(std::vector<std::vector<int>>& board, int depth, Placed placed) {
+    typedef typename Geometry::Mask Mask;
+    typedef typename Geometry::Ops Ops;
+    for (auto& row : board) {
+        std::fill(row.begin(), row.end(), 0);
+    }
+    for (int d = 0; d < depth; d++) {
+        std::pair<int, Mask> piece = placed(d);
+        Mask mask = piece.second;
+        while (!Ops::empty(mask)) {
+            int index = Ops::lowestBit(mask);
+            board[index / Geometry::SIZE][index % Geometry::SIZE] = piece.first;
+            mask = mask ^ Ops::bit(index);
+        }
+    }
+}
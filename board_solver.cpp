@@ -0,0 +1,109 @@
+#include "board_solver.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// 掩码类型与几何在编译期确定，这里顺便校验
+static_assert(is_same<Board<8>::Mask, uint64_t>::value, "8x8 board must use a single 64-bit word");
+static_assert(Board<8>::cellBit(7, 7) == (1ULL << 63), "8x8 cell numbering");
+static_assert(Board<8>::full() == ~0ULL, "8x8 full mask");
+static_assert(Board<6>::full() == (1ULL << 36) - 1, "6x6 full mask");
+static_assert(sizeof(Board<10>::Mask) == 16, "10x10 board must use two words");
+static_assert(sizeof(Board<12>::Mask) == 24, "12x12 board must use three words");
+static_assert(Board<12>::cellBit(11, 11) == MaskOps<Board<12>::Mask>::bit(143), "12x12 cell numbering");
+
+// 编译期放置表的规模（标准图块在完整棋盘上的放置数）
+static_assert(StandardPlacements<8>::COUNT == 1578, "8x8 standard placement count");
+static_assert(StandardPlacements<8>::table.anchoredStart[Board<8>::CELLS] == StandardPlacements<8>::COUNT,
+              "every placement has exactly one lowest cell");
+
+template <int N>
+BoardSolver<N>::BoardSolver(Mask blocked)
+    : pieces(standardPieces()), placementTotal(0), blocked(blocked), occupied(), nodes(0) {
+    typedef StandardPlacements<N> Standard;
+    const typename Standard::Table& full = Standard::table;
+    cellCounts.assign(full.cellCounts, full.cellCounts + Standard::TYPES);
+    anchored.assign(Geometry::CELLS, vector<Candidate>());
+    chosen.assign(Geometry::CELLS, Candidate());
+    solutionBoard.assign(N, vector<int>(N, 0));
+
+    // 每格的候选在编译期已按图块大小降序排列（大的先放），这里只去掉被挡住的放置
+    for (int cell = 0; cell < Geometry::CELLS; cell++) {
+        for (int k = full.anchoredStart[cell]; k < full.anchoredStart[cell + 1]; k++) {
+            int i = full.anchoredList[k];
+            if (!Geometry::Ops::empty(full.masks[i] & blocked)) continue;
+            anchored[cell].push_back({full.masks[i], full.type[i]});
+            placementTotal++;
+        }
+    }
+}
+
+template <int N>
+bool BoardSolver<N>::solve(const vector<PieceCount>& counts, double timeLimitSeconds) {
+    remaining.assign(pieces.size(), 0);
+    occupied = blocked;
+    nodes = 0;
+    limits.start(timeLimitSeconds);
+
+    int requiredCells = 0;
+    for (const auto& pc : counts) {
+        if (pc.count <= 0) continue;
+        int type = -1;
+        for (size_t t = 0; t < pieces.size(); t++) {
+            if (pieces[t].id == pc.pieceId) type = (int)t;
+        }
+        if (type < 0 || cellCounts[type] == 0) return false;
+        remaining[type] += pc.count;
+        requiredCells += pc.count * cellCounts[type];
+    }
+    // 只有总面积正好等于棋盘（除去被挡住的格子）的面积时才可能填满
+    if (requiredCells != Geometry::CELLS - Geometry::Ops::count(blocked)) return false;
+
+    // 没有用到的图块不必在每个节点上逐个跳过
+    active.resize(Geometry::CELLS);
+    for (int cell = 0; cell < Geometry::CELLS; cell++) {
+        active[cell].clear();
+        for (const Candidate& candidate : anchored[cell]) {
+            if (remaining[candidate.type] > 0) active[cell].push_back(candidate);
+        }
+    }
+    return search(0);
+}
+
+template <int N>
+bool BoardSolver<N>::search(int depth) {
+    nodes++;
+    if (limits.check(nodes)) return false;
+
+    constexpr Mask full = Geometry::full();
+    if (occupied == full) {
+        buildSolutionBoard<Geometry>(solutionBoard, depth, [this](int d) {
+            return make_pair(pieces[chosen[d].type].id, chosen[d].mask);
+        });
+        return true;
+    }
+    if (!regionsFeasible<Geometry>(occupied, cellCounts, remaining)) return false;
+
+    // 最低的空格必须被覆盖，且覆盖它的放置不能占用更低的格子（都已被占用）
+    // 重叠测试对每种掩码类型都是固定次数的AND和比较，没有依赖数据的提前退出
+    int cell = Geometry::Ops::lowestBit(~occupied & full);
+    for (const Candidate& candidate : active[cell]) {
+        if (remaining[candidate.type] <= 0) continue;
+        if (!Geometry::Ops::empty(candidate.mask & occupied)) continue;
+        occupied = occupied | candidate.mask;
+        remaining[candidate.type]--;
+        chosen[depth] = candidate;
+        if (search(depth + 1)) return true;
+        remaining[candidate.type]++;
+        occupied = occupied ^ candidate.mask;
+        if (limits.stopped) return false;
+    }
+    return false;
+}
+
+// 显式实例化支持的尺寸：实现留在本文件中，其他文件只包含声明
+template class BoardSolver<6>;
+template class BoardSolver<8>;
+template class BoardSolver<10>;
+template class BoardSolver<12>;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "board_search.h"
+#include "standard_placements.h"
+
+// 按棋盘尺寸模板化的求解器：BoardSolver<N>求解N x N棋盘，掩码类型由Board<N>在编译时决定
+// 与BRANCH_FIRST_EMPTY相同的搜索：总是覆盖最低的空格，只尝试以该格为最低格的放置，
+// 每个节点检查各空区域的面积能否由剩余图块凑出
+// 已实例化的尺寸：6、8、10、12（见board_solver.cpp末尾，需要其他尺寸时在那里添加）
+// 这是8x8以外尺寸的唯一搜索路径（目前只有puzzle_batch --size使用）：BitboardSolver、其他引擎和GUI都只支持8x8，
+// 这里没有置换表、奇偶剪枝和其他分支方式
+template <int N>
+class BoardSolver {
+public:
+    typedef Board<N> Geometry;
+    typedef typename Geometry::Mask Mask;
+
+    // 图块为标准图块库，放置取自编译期生成的StandardPlacements<N>，构造时只去掉占用blocked中格子的放置
+    // blocked为不规则棋盘上被挡住的格子，搜索开始时当作已占用
+    explicit BoardSolver(Mask blocked = Mask());
+
+    // counts按pieceId匹配图块；timeLimitSeconds <= 0 表示不限时
+    bool solve(const std::vector<PieceCount>& counts, double timeLimitSeconds);
+
+    // cancel被置为true后搜索尽快停止（每1024个节点检查一次）
+    void setCancelFlag(const std::atomic<bool>* cancel) { limits.cancelFlag = cancel; }
+
+    bool timedOut() const { return limits.timeout; }
+    bool cancelled() const { return limits.cancelRequested; }
+    long long nodeCount() const { return nodes; }
+    int placementCount() const { return placementTotal; }
+    // 解的棋盘（N x N，单元格为pieceId，0为空），仅在solve()返回true后有效
+    const std::vector<std::vector<int>>& solution() const { return solutionBoard; }
+
+private:
+    // 一个放置：连续存放在以其最低格为索引的列表中，内层循环只读这一个数组
+    struct Candidate {
+        Mask mask;
+        int type;
+    };
+
+    bool search(int depth);
+
+    std::vector<SolverPiece> pieces;
+    std::vector<int> cellCounts;
+    std::vector<std::vector<Candidate>> anchored;  // anchored[cell] = 以cell为最低格的放置，大图块在前
+    std::vector<std::vector<Candidate>> active;    // anchored中本次求解用到的图块（数量大于0）的放置
+    std::vector<int> remaining;
+    std::vector<Candidate> chosen;                 // chosen[depth] = 该层选择的放置
+    int placementTotal;
+    Mask blocked;
+    Mask occupied;
+    long long nodes;
+    SearchLimits limits;
+    std::vector<std::vector<int>> solutionBoard;
+};
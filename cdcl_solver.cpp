@@ -0,0 +1,453 @@
+#include "cdcl_solver.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+const double VAR_DECAY = 0.95;
+const int RESTART_BASE = 100;  // Luby序列的单位（冲突数）
+
+// Luby序列：1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...（第index项，从0开始）
+long long luby(int index) {
+    long long size = 1;
+    int sequence = 0;
+    while (size < index + 1) {
+        sequence++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != index) {
+        size = (size - 1) / 2;
+        sequence--;
+        index %= size;
+    }
+    return 1LL << sequence;
+}
+
+}  // namespace
+
+CdclSolver::CdclSolver()
+    : propagateHead(0), originalClauses(0), learntCount(0), maxLearnts(0.0), varIncrement(1.0),
+      unsatisfiable(false), timeout(false), cancelRequested(false), timeLimit(0.0), cancelFlag(nullptr) {
+}
+
+int CdclSolver::newVar() {
+    int var = (int)assigns.size();
+    assigns.push_back(0);
+    levels.push_back(0);
+    reasons.push_back(-1);
+    savedPhase.push_back(false);
+    activity.push_back(0.0);
+    heapIndex.push_back(-1);
+    seen.push_back(0);
+    watches.emplace_back();
+    watches.emplace_back();
+    heapInsert(var);
+    return var;
+}
+
+void CdclSolver::addClause(vector<SatLiteral> literals) {
+    sort(literals.begin(), literals.end());
+    literals.erase(unique(literals.begin(), literals.end()), literals.end());
+    for (size_t i = 1; i < literals.size(); i++) {
+        if (literals[i] == negateLiteral(literals[i - 1])) return;  // 恒真
+    }
+
+    originalClauses++;
+    if (literals.empty()) {
+        unsatisfiable = true;
+    } else if (literals.size() == 1) {
+        pendingUnits.push_back(literals[0]);
+    } else {
+        attachClause(allocateClause(literals, false, 0));
+    }
+}
+
+int CdclSolver::allocateClause(vector<SatLiteral>& literals, bool learnt, int lbd) {
+    int index;
+    if (!freeClauses.empty()) {
+        index = freeClauses.back();
+        freeClauses.pop_back();
+    } else {
+        index = (int)clauses.size();
+        clauses.emplace_back();
+    }
+    Clause& clause = clauses[index];
+    clause.literals.swap(literals);
+    clause.learnt = learnt;
+    clause.deleted = false;
+    clause.lbd = lbd;
+    return index;
+}
+
+void CdclSolver::attachClause(int clause) {
+    const vector<SatLiteral>& literals = clauses[clause].literals;
+    watches[negateLiteral(literals[0])].push_back({clause, literals[1]});
+    watches[negateLiteral(literals[1])].push_back({clause, literals[0]});
+}
+
+void CdclSolver::enqueue(SatLiteral literal, int reason) {
+    int var = literalVar(literal);
+    assigns[var] = (literal & 1) ? -1 : 1;
+    levels[var] = decisionLevel();
+    reasons[var] = reason;
+    trail.push_back(literal);
+}
+
+int CdclSolver::propagate() {
+    int conflict = -1;
+    while (propagateHead < (int)trail.size()) {
+        SatLiteral literal = trail[propagateHead++];
+        SatLiteral falseLiteral = negateLiteral(literal);
+        vector<Watcher>& list = watches[literal];
+        stats.propagations++;
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < list.size()) {
+            Watcher watcher = list[i++];
+            if (literalValue(watcher.blocker) == 1) {
+                list[j++] = watcher;
+                continue;
+            }
+
+            vector<SatLiteral>& literals = clauses[watcher.clause].literals;
+            if (literals[0] == falseLiteral) {
+                swap(literals[0], literals[1]);
+            }
+            SatLiteral first = literals[0];
+            Watcher updated = {watcher.clause, first};
+            if (first != watcher.blocker && literalValue(first) == 1) {
+                list[j++] = updated;
+                continue;
+            }
+
+            // 找一个不为假的文字代替falseLiteral作为观察文字
+            bool moved = false;
+            for (size_t k = 2; k < literals.size(); k++) {
+                if (literalValue(literals[k]) != -1) {
+                    swap(literals[1], literals[k]);
+                    watches[negateLiteral(literals[1])].push_back(updated);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            // 除first外都为假：first为假则冲突，否则推出first
+            list[j++] = updated;
+            if (literalValue(first) == -1) {
+                conflict = watcher.clause;
+                propagateHead = (int)trail.size();
+                while (i < list.size()) {
+                    list[j++] = list[i++];
+                }
+            } else {
+                enqueue(first, watcher.clause);
+            }
+        }
+        list.resize(j);
+    }
+    return conflict;
+}
+
+void CdclSolver::analyze(int conflict, vector<SatLiteral>& learnt, int& backtrackLevel, int& lbd) {
+    learnt.clear();
+    learnt.push_back(0);  // 占位，最后放入1UIP文字的否定
+    int pathCount = 0;
+    SatLiteral literal = -1;
+    int index = (int)trail.size() - 1;
+
+    // 从冲突子句出发沿推理原因回溯，直到当前层只剩一个文字（第一个唯一蕴含点）
+    do {
+        const vector<SatLiteral>& literals = clauses[conflict].literals;
+        for (size_t k = (literal == -1 ? 0 : 1); k < literals.size(); k++) {
+            SatLiteral q = literals[k];
+            int var = literalVar(q);
+            if (seen[var] || levels[var] == 0) continue;
+            seen[var] = 1;
+            bumpVar(var);
+            if (levels[var] >= decisionLevel()) {
+                pathCount++;
+            } else {
+                learnt.push_back(q);
+            }
+        }
+        while (!seen[literalVar(trail[index])]) {
+            index--;
+        }
+        literal = trail[index--];
+        conflict = reasons[literalVar(literal)];
+        seen[literalVar(literal)] = 0;
+        pathCount--;
+    } while (pathCount > 0);
+    learnt[0] = negateLiteral(literal);
+
+    // 去掉被学习子句中其余文字直接蕴含的文字（其推理原因中的其他文字都已在子句中）；
+    // 压缩会覆盖被去掉的文字，所以先记下要清除标记的变量
+    vector<SatLiteral> marked(learnt.begin() + 1, learnt.end());
+    size_t kept = 1;
+    for (size_t k = 1; k < learnt.size(); k++) {
+        if (!redundant(learnt[k])) {
+            learnt[kept++] = learnt[k];
+        }
+    }
+    learnt.resize(kept);
+    for (SatLiteral q : marked) {
+        seen[literalVar(q)] = 0;
+    }
+
+    // 回溯到第二高的决策层，并把该层的文字放在位置1作为第二个观察文字
+    backtrackLevel = 0;
+    if (learnt.size() > 1) {
+        size_t highest = 1;
+        for (size_t k = 2; k < learnt.size(); k++) {
+            if (levels[literalVar(learnt[k])] > levels[literalVar(learnt[highest])]) highest = k;
+        }
+        swap(learnt[1], learnt[highest]);
+        backtrackLevel = levels[literalVar(learnt[1])];
+    }
+
+    vector<int> distinctLevels;
+    for (SatLiteral q : learnt) {
+        distinctLevels.push_back(levels[literalVar(q)]);
+    }
+    sort(distinctLevels.begin(), distinctLevels.end());
+    lbd = (int)(unique(distinctLevels.begin(), distinctLevels.end()) - distinctLevels.begin());
+}
+
+bool CdclSolver::redundant(SatLiteral literal) const {
+    int reason = reasons[literalVar(literal)];
+    if (reason < 0) return false;
+    const vector<SatLiteral>& literals = clauses[reason].literals;
+    for (size_t k = 1; k < literals.size(); k++) {
+        int var = literalVar(literals[k]);
+        if (!seen[var] && levels[var] > 0) return false;
+    }
+    return true;
+}
+
+void CdclSolver::cancelUntil(int level) {
+    if (decisionLevel() <= level) return;
+    for (int k = (int)trail.size() - 1; k >= trailLimits[level]; k--) {
+        int var = literalVar(trail[k]);
+        savedPhase[var] = (assigns[var] == 1);
+        assigns[var] = 0;
+        reasons[var] = -1;
+        heapInsert(var);
+    }
+    trail.resize(trailLimits[level]);
+    trailLimits.resize(level);
+    propagateHead = (int)trail.size();
+}
+
+SatLiteral CdclSolver::pickBranchLiteral() {
+    while (!heap.empty()) {
+        int var = heapPop();
+        if (assigns[var] == 0) {
+            return savedPhase[var] ? positiveLiteral(var) : negativeLiteral(var);
+        }
+    }
+    return -1;
+}
+
+bool CdclSolver::checkStop() {
+    if (cancelFlag && cancelFlag->load(memory_order_relaxed)) {
+        cancelRequested = true;
+    } else if (timeLimit > 0.0) {
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+        if (elapsed.count() > timeLimit) {
+            timeout = true;
+        }
+    }
+    return timeout || cancelRequested;
+}
+
+SatResult CdclSolver::solve(double timeLimitSeconds) {
+    timeout = false;
+    cancelRequested = false;
+    timeLimit = timeLimitSeconds;
+    startTime = chrono::steady_clock::now();
+    if (unsatisfiable) return SAT_UNSATISFIABLE;
+
+    for (SatLiteral literal : pendingUnits) {
+        int value = literalValue(literal);
+        if (value == -1) return SAT_UNSATISFIABLE;
+        if (value == 0) enqueue(literal, -1);
+    }
+    pendingUnits.clear();
+    if (propagate() >= 0) {
+        unsatisfiable = true;
+        return SAT_UNSATISFIABLE;
+    }
+
+    maxLearnts = max(5000.0, originalClauses / 3.0);
+    for (int restart = 0;; restart++) {
+        SatResult result = search(luby(restart) * RESTART_BASE);
+        if (result != SAT_UNKNOWN || timeout || cancelRequested) {
+            cancelUntil(0);
+            return result;
+        }
+        stats.restarts++;
+    }
+}
+
+SatResult CdclSolver::search(long long conflictBudget) {
+    long long conflictsHere = 0;
+    vector<SatLiteral> learnt;
+    while (true) {
+        int conflict = propagate();
+        if (conflict >= 0) {
+            stats.conflicts++;
+            conflictsHere++;
+            if (decisionLevel() == 0) {
+                unsatisfiable = true;
+                return SAT_UNSATISFIABLE;
+            }
+
+            int backtrackLevel = 0;
+            int lbd = 0;
+            analyze(conflict, learnt, backtrackLevel, lbd);
+            cancelUntil(backtrackLevel);
+            if (learnt.size() == 1) {
+                enqueue(learnt[0], -1);
+            } else {
+                SatLiteral asserting = learnt[0];
+                int clause = allocateClause(learnt, true, lbd);
+                attachClause(clause);
+                enqueue(asserting, clause);
+                learntCount++;
+                stats.learnedClauses++;
+            }
+            varIncrement /= VAR_DECAY;
+
+            // 每256次冲突检查一次时间和取消标志
+            if ((stats.conflicts & 255) == 0 && checkStop()) return SAT_UNKNOWN;
+        } else {
+            if (conflictsHere >= conflictBudget) {
+                cancelUntil(0);
+                return SAT_UNKNOWN;  // 重启
+            }
+            if (learntCount - (int)trail.size() >= maxLearnts) {
+                reduceLearnts();
+            }
+
+            SatLiteral next = pickBranchLiteral();
+            if (next < 0) {
+                model.assign(assigns.size(), false);
+                for (size_t var = 0; var < assigns.size(); var++) {
+                    model[var] = (assigns[var] == 1);
+                }
+                return SAT_SATISFIABLE;
+            }
+            stats.decisions++;
+            if ((stats.decisions & 1023) == 0 && checkStop()) return SAT_UNKNOWN;
+            trailLimits.push_back((int)trail.size());
+            enqueue(next, -1);
+        }
+    }
+}
+
+bool CdclSolver::locked(int clause) const {
+    SatLiteral first = clauses[clause].literals[0];
+    return reasons[literalVar(first)] == clause && literalValue(first) == 1;
+}
+
+void CdclSolver::reduceLearnts() {
+    // 删除一半LBD较大的学习子句（LBD <= 2的子句和正作为推理原因的子句保留）
+    vector<int> candidates;
+    for (size_t c = 0; c < clauses.size(); c++) {
+        const Clause& clause = clauses[c];
+        if (clause.learnt && !clause.deleted && clause.lbd > 2 && !locked((int)c)) {
+            candidates.push_back((int)c);
+        }
+    }
+    sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        if (clauses[a].lbd != clauses[b].lbd) return clauses[a].lbd > clauses[b].lbd;
+        return clauses[a].literals.size() > clauses[b].literals.size();
+    });
+    size_t removeCount = candidates.size() / 2;
+    for (size_t k = 0; k < removeCount; k++) {
+        Clause& clause = clauses[candidates[k]];
+        clause.deleted = true;
+        clause.literals.clear();
+        clause.literals.shrink_to_fit();
+        learntCount--;
+        stats.deletedClauses++;
+    }
+
+    // 立即清理观察列表，被删除的位置之后才能安全复用
+    for (auto& list : watches) {
+        list.erase(remove_if(list.begin(), list.end(),
+                             [this](const Watcher& w) { return clauses[w.clause].deleted; }),
+                   list.end());
+    }
+    for (size_t k = 0; k < removeCount; k++) {
+        freeClauses.push_back(candidates[k]);
+    }
+    maxLearnts *= 1.1;
+}
+
+void CdclSolver::bumpVar(int var) {
+    activity[var] += varIncrement;
+    if (activity[var] > 1e100) {
+        // 整体缩小，避免溢出（相对大小不变）
+        for (double& a : activity) {
+            a *= 1e-100;
+        }
+        varIncrement *= 1e-100;
+    }
+    if (heapIndex[var] >= 0) {
+        heapUp(heapIndex[var]);
+    }
+}
+
+void CdclSolver::heapInsert(int var) {
+    if (heapIndex[var] >= 0) return;
+    heapIndex[var] = (int)heap.size();
+    heap.push_back(var);
+    heapUp(heapIndex[var]);
+}
+
+int CdclSolver::heapPop() {
+    int top = heap[0];
+    heapIndex[top] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heap[0] = last;
+        heapIndex[last] = 0;
+        heapDown(0);
+    }
+    return top;
+}
+
+void CdclSolver::heapUp(int position) {
+    int var = heap[position];
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (activity[heap[parent]] >= activity[var]) break;
+        heap[position] = heap[parent];
+        heapIndex[heap[position]] = position;
+        position = parent;
+    }
+    heap[position] = var;
+    heapIndex[var] = position;
+}
+
+void CdclSolver::heapDown(int position) {
+    int var = heap[position];
+    int size = (int)heap.size();
+    while (true) {
+        int child = 2 * position + 1;
+        if (child >= size) break;
+        if (child + 1 < size && activity[heap[child + 1]] > activity[heap[child]]) child++;
+        if (activity[heap[child]] <= activity[var]) break;
+        heap[position] = heap[child];
+        heapIndex[heap[position]] = position;
+        position = child;
+    }
+    heap[position] = var;
+    heapIndex[var] = position;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// 文字：变量v的正文字为2v，负文字为2v+1
+typedef int SatLiteral;
+
+inline SatLiteral positiveLiteral(int var) { return var * 2; }
+inline SatLiteral negativeLiteral(int var) { return var * 2 + 1; }
+inline SatLiteral negateLiteral(SatLiteral literal) { return literal ^ 1; }
+inline int literalVar(SatLiteral literal) { return literal >> 1; }
+
+enum SatResult {
+    SAT_SATISFIABLE,
+    SAT_UNSATISFIABLE,
+    SAT_UNKNOWN  // 超时或被取消
+};
+
+struct CdclStats {
+    long long decisions = 0;
+    long long propagations = 0;
+    long long conflicts = 0;
+    long long restarts = 0;
+    long long learnedClauses = 0;
+    long long deletedClauses = 0;
+};
+
+// 内置的CDCL SAT求解器，不依赖外部库或服务：
+// 两个观察文字的单元传播、1UIP冲突分析和学习子句（去掉被其余文字蕴含的文字）、
+// VSIDS变量活跃度、相位保存、按Luby序列重启、按LBD定期删除一半学习子句
+class CdclSolver {
+public:
+    CdclSolver();
+
+    int newVar();
+    int varCount() const { return (int)assigns.size(); }
+    int clauseCount() const { return originalClauses; }
+
+    // 在solve()之前添加子句；重复文字会被合并，同时含x和非x的子句被忽略，空子句使问题无解
+    void addClause(std::vector<SatLiteral> literals);
+
+    // cancel被置为true后solve()尽快返回SAT_UNKNOWN
+    void setCancelFlag(const std::atomic<bool>* cancel) { cancelFlag = cancel; }
+
+    // timeLimitSeconds <= 0 表示不限时
+    SatResult solve(double timeLimitSeconds);
+
+    // 可满足时变量在模型中的值
+    bool modelValue(int var) const { return model[var]; }
+    bool timedOut() const { return timeout; }
+    bool cancelled() const { return cancelRequested; }
+    const CdclStats& statistics() const { return stats; }
+
+private:
+    struct Clause {
+        std::vector<SatLiteral> literals;  // 前两个为观察文字；作为推理原因时literals[0]为被推出的文字
+        bool learnt;
+        bool deleted;
+        int lbd;  // 学习子句中不同决策层的个数（越小越有用）
+    };
+
+    // 观察literal的子句：literal变为真时其否定（子句中的观察文字）变为假，需要检查该子句
+    struct Watcher {
+        int clause;
+        SatLiteral blocker;  // 子句中的另一个文字，为真时不必访问子句
+    };
+
+    // 变量赋值：1为真，-1为假，0为未赋值
+    int literalValue(SatLiteral literal) const {
+        int value = assigns[literalVar(literal)];
+        return (literal & 1) ? -value : value;
+    }
+    int decisionLevel() const { return (int)trailLimits.size(); }
+
+    int allocateClause(std::vector<SatLiteral>& literals, bool learnt, int lbd);
+    void attachClause(int clause);
+    void enqueue(SatLiteral literal, int reason);
+    int propagate();
+    void analyze(int conflict, std::vector<SatLiteral>& learnt, int& backtrackLevel, int& lbd);
+    bool redundant(SatLiteral literal) const;
+    void cancelUntil(int level);
+    SatLiteral pickBranchLiteral();
+    SatResult search(long long conflictBudget);
+    void reduceLearnts();
+    bool locked(int clause) const;
+    bool checkStop();
+
+    void bumpVar(int var);
+    void heapInsert(int var);
+    int heapPop();
+    void heapUp(int position);
+    void heapDown(int position);
+
+    std::vector<Clause> clauses;
+    std::vector<int> freeClauses;                 // 被删除、可以复用的子句位置
+    std::vector<std::vector<Watcher>> watches;    // 按文字索引
+    std::vector<int> assigns;
+    std::vector<int> levels;
+    std::vector<int> reasons;                     // 推出该变量的子句，决策变量和第0层的单元为-1
+    std::vector<bool> savedPhase;                 // 回溯时保存的取值，下次决策沿用
+    std::vector<double> activity;
+    std::vector<int> heap;                        // 按activity的二叉大顶堆
+    std::vector<int> heapIndex;                   // 变量在heap中的位置，-1表示不在堆中
+    std::vector<SatLiteral> trail;
+    std::vector<int> trailLimits;                 // 每个决策层在trail中的起点
+    std::vector<SatLiteral> pendingUnits;         // addClause()收到的单元子句，solve()开始时赋值
+    std::vector<char> seen;                       // analyze()中的临时标记
+    std::vector<bool> model;
+    int propagateHead;
+    int originalClauses;
+    int learntCount;
+    double maxLearnts;
+    double varIncrement;
+    bool unsatisfiable;                           // 添加子句时已经发现无解
+    bool timeout;
+    bool cancelRequested;
+    double timeLimit;
+    std::chrono::steady_clock::time_point startTime;
+    const std::atomic<bool>* cancelFlag;
+    CdclStats stats;
+};
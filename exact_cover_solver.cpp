@@ -0,0 +1,187 @@
+#include "exact_cover_solver.h"
+
+#include "board_search.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// 节点布局：0为根节点，1..BOARD_CELLS为单元格列头（被挡住的格子的列头不挂到根节点，也没有行），
+// 之后是每种图块的数量列头，再之后是所有行节点
+
+ExactCoverSolver::ExactCoverSolver(const PlacementTable& table)
+    : table(table), nodes(0) {
+    chosenRows.assign(BOARD_CELLS, -1);
+    solutionBoard.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
+}
+
+int ExactCoverSolver::addColumnHeader(bool primary) {
+    int index = (int)links.size();
+    Node header = {index, index, index, index, index, -1};
+    if (primary) {
+        // 主列挂到根节点的环形链表末尾
+        header.left = links[0].left;
+        header.right = 0;
+        links[links[0].left].right = index;
+        links[0].left = index;
+    }
+    links.push_back(header);
+    columnSize.push_back(0);
+    return index;
+}
+
+void ExactCoverSolver::build(const vector<int>& quotas) {
+    links.clear();
+    columnSize.clear();
+    rowType.clear();
+    rowPlacement.clear();
+    quota = quotas;
+
+    links.push_back({0, 0, 0, 0, 0, -1});
+    columnSize.push_back(0);
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        addColumnHeader(!(table.blocked & (1ULL << cell)));
+    }
+    // 数量列不挂到根节点：不要求被选中，只在配额用完时被覆盖
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        addColumnHeader(false);
+    }
+
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        if (quota[t] <= 0) continue;
+        const auto& list = table.placements[t];
+        for (size_t i = 0; i < list.size(); i++) {
+            int row = (int)rowType.size();
+            rowType.push_back((int)t);
+            rowPlacement.push_back((int)i);
+
+            // 行内节点：先数量列，再按位顺序的单元格列
+            int first = -1;
+            auto appendNode = [&](int column) {
+                int index = (int)links.size();
+                Node node;
+                node.column = column;
+                node.row = row;
+                node.up = links[column].up;
+                node.down = column;
+                links[links[column].up].down = index;
+                links[column].up = index;
+                columnSize[column]++;
+                if (first < 0) {
+                    first = index;
+                    node.left = index;
+                    node.right = index;
+                } else {
+                    node.left = links[first].left;
+                    node.right = first;
+                    links[links[first].left].right = index;
+                    links[first].left = index;
+                }
+                links.push_back(node);
+                columnSize.push_back(0);
+            };
+
+            appendNode(BOARD_CELLS + 1 + (int)t);
+            BoardMask mask = list[i].mask;
+            while (mask) {
+                appendNode(1 + lowestBitIndex(mask));
+                mask &= mask - 1;
+            }
+        }
+    }
+}
+
+void ExactCoverSolver::cover(int column) {
+    links[links[column].right].left = links[column].left;
+    links[links[column].left].right = links[column].right;
+    for (int i = links[column].down; i != column; i = links[i].down) {
+        for (int j = links[i].right; j != i; j = links[j].right) {
+            links[links[j].down].up = links[j].up;
+            links[links[j].up].down = links[j].down;
+            columnSize[links[j].column]--;
+        }
+    }
+}
+
+void ExactCoverSolver::uncover(int column) {
+    for (int i = links[column].up; i != column; i = links[i].up) {
+        for (int j = links[i].left; j != i; j = links[j].left) {
+            columnSize[links[j].column]++;
+            links[links[j].down].up = j;
+            links[links[j].up].down = j;
+        }
+    }
+    links[links[column].right].left = column;
+    links[links[column].left].right = column;
+}
+
+bool ExactCoverSolver::solve(const vector<PieceCount>& counts, double timeLimitSeconds) {
+    nodes = 0;
+    limits.start(timeLimitSeconds);
+
+    vector<int> quotas(table.pieces.size(), 0);
+    int requiredCells = 0;
+    for (const auto& pc : counts) {
+        if (pc.count <= 0) continue;
+        int type = table.typeIndexOf(pc.pieceId);
+        // 未知图块或无法放入棋盘的图块：不可能用满指定数量
+        if (type < 0 || table.placements[type].empty()) return false;
+        quotas[type] += pc.count;
+        requiredCells += pc.count * table.cellCounts[type];
+    }
+
+    // 面积正好等于棋盘面积时，覆盖全部单元格列即意味着所有配额都正好用完
+    if (requiredCells != table.openCells()) return false;
+    if (!parityFeasible(analyzeParity(table, quotas), table.blocked, quotas)) return false;
+
+    build(quotas);
+    return search(0);
+}
+
+bool ExactCoverSolver::search(int depth) {
+    nodes++;
+    if (limits.check(nodes)) return false;
+
+    if (links[0].right == 0) {
+        buildSolutionBoard<Board<BOARD_SIZE>>(solutionBoard, depth, [this](int d) {
+            int row = chosenRows[d];
+            return make_pair(table.pieces[rowType[row]].id, table.placements[rowType[row]][rowPlacement[row]].mask);
+        });
+        return true;
+    }
+
+    // 选择候选行最少的单元格列
+    int column = links[0].right;
+    for (int c = links[column].right; c != 0; c = links[c].right) {
+        if (columnSize[c] < columnSize[column]) column = c;
+    }
+    if (columnSize[column] == 0) return false;
+
+    cover(column);
+    for (int r = links[column].down; r != column; r = links[r].down) {
+        chosenRows[depth] = links[r].row;
+        for (int j = links[r].right; j != r; j = links[j].right) {
+            int c = links[j].column;
+            if (isTypeColumn(c)) {
+                // 配额用完：覆盖数量列，删除该图块的所有剩余放置
+                if (--quota[c - BOARD_CELLS - 1] == 0) cover(c);
+            } else {
+                cover(c);
+            }
+        }
+
+        if (search(depth + 1)) return true;
+
+        for (int j = links[r].left; j != r; j = links[j].left) {
+            int c = links[j].column;
+            if (isTypeColumn(c)) {
+                if (quota[c - BOARD_CELLS - 1]++ == 0) uncover(c);
+            } else {
+                uncover(c);
+            }
+        }
+        if (limits.stopped) break;
+    }
+    uncover(column);
+    return false;
+}
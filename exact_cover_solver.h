@@ -0,0 +1,51 @@
+#pragma once
+
+#include "puzzle_solver.h"
+
+// 精确覆盖求解器（Dancing Links）
+// 模型：64个单元格列（每格必须被覆盖正好一次）+ 每种图块一个数量列，
+// 数量列带剩余配额，配额用完时才覆盖该列（删除该图块的所有剩余放置），
+// 相当于Knuth Algorithm M中的多重性列
+// 每层选择候选放置最少的单元格列分支
+class ExactCoverSolver {
+public:
+    explicit ExactCoverSolver(const PlacementTable& table);
+
+    // counts按pieceId匹配放置表中的图块类型；timeLimitSeconds <= 0 表示不限时
+    bool solve(const std::vector<PieceCount>& counts, double timeLimitSeconds);
+
+    // cancel被置为true后搜索尽快停止（每1024个节点检查一次）
+    void setCancelFlag(const std::atomic<bool>* cancel) { limits.cancelFlag = cancel; }
+
+    bool timedOut() const { return limits.timeout; }
+    bool cancelled() const { return limits.cancelRequested; }
+    long long nodeCount() const { return nodes; }
+    // 解的棋盘（单元格为pieceId，0为空），仅在solve()返回true后有效
+    const std::vector<std::vector<int>>& solution() const { return solutionBoard; }
+
+private:
+    // 十字链表节点；列头的column指向自身，row为-1
+    struct Node {
+        int left, right, up, down;
+        int column;
+        int row;
+    };
+
+    void build(const std::vector<int>& quotas);
+    int addColumnHeader(bool primary);
+    void cover(int column);
+    void uncover(int column);
+    bool isTypeColumn(int column) const { return column > BOARD_CELLS; }
+    bool search(int depth);
+
+    const PlacementTable& table;
+    std::vector<Node> links;
+    std::vector<int> columnSize;     // 按节点索引，仅列头有效
+    std::vector<int> quota;          // 每种图块的剩余配额（按图块类型索引）
+    std::vector<int> rowType;        // 行 -> 图块类型
+    std::vector<int> rowPlacement;   // 行 -> 放置表中的索引
+    std::vector<int> chosenRows;     // chosenRows[depth] = 该层选择的行
+    long long nodes;
+    SearchLimits limits;  // 与BitboardSolver相同的时间限制和取消检查
+    std::vector<std::vector<int>> solutionBoard;
+};
@@ -0,0 +1,184 @@
+#include "parallel_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+// 只在这个深度以内拆分子树：更深的子树太小，交给其他线程的开销（重放路径、同步）得不偿失
+const int PARALLEL_SPLIT_DEPTH = 16;
+
+}  // namespace
+
+ParallelSolver::ParallelSolver(const PlacementTable& table, const SolverOptions& options, int threadCount)
+    : idleWorkers(0), taskVersion(0), cancel(false), externalCancel(nullptr), finished(false), timeout(false),
+      cancelRequested(false), solutionFound(false), nodes(0), steals(0) {
+    if (threadCount <= 0) {
+        threadCount = max(1, (int)thread::hardware_concurrency());
+    }
+
+    // 置换表按线程平分内存预算
+    SolverOptions workerOptions = options;
+    if (options.transpositionMegabytes > 0) {
+        workerOptions.transpositionMegabytes = max((size_t)1, options.transpositionMegabytes / threadCount);
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        unique_ptr<Worker> worker(new Worker());
+        worker->owner = this;
+        worker->index = i;
+        worker->queued = 0;
+        worker->steals = 0;
+        worker->solver.reset(new BitboardSolver(table, workerOptions));
+        worker->solver->setSplitter(worker.get(), PARALLEL_SPLIT_DEPTH);
+        worker->solver->setCancelFlag(&cancel);
+        workers.push_back(move(worker));
+    }
+    solutionBoard.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
+}
+
+bool ParallelSolver::Worker::hungry() const {
+    // 空闲线程比自己队列里已有的任务多时才继续拆分
+    return owner->idleWorkers.load(memory_order_relaxed) > queued.load(memory_order_relaxed);
+}
+
+void ParallelSolver::Worker::donate(const SearchPath& path) {
+    {
+        lock_guard<mutex> lock(taskMutex);
+        tasks.push_back(path);
+        queued++;
+    }
+    // 只在有线程空闲时才会交出子树（见hungry()），这时才需要经过stateMutex唤醒它们；
+    // 等待中的还有调用solve()的线程，所以唤醒全部
+    lock_guard<mutex> lock(owner->stateMutex);
+    owner->taskVersion++;
+    owner->queueChanged.notify_all();
+}
+
+bool ParallelSolver::solve(const vector<PieceCount>& counts, double timeLimitSeconds) {
+    cancel = false;
+    idleWorkers = 0;
+    taskVersion = 0;
+    finished = false;
+    timeout = false;
+    cancelRequested = false;
+    solutionFound = false;
+    nodes = 0;
+    steals = 0;
+
+    // 所有线程求解同一个实例：面积或染色奇偶性不满足时每个线程都会得到同样的结论
+    for (auto& worker : workers) {
+        worker->tasks.clear();
+        worker->queued = 0;
+        worker->steals = 0;
+        if (!worker->solver->start(counts, timeLimitSeconds)) {
+            stats = worker->solver->statistics();
+            return false;
+        }
+    }
+
+    // 整棵树（空路径）作为第一个任务，其他线程空闲后从它拆分出的子树开始
+    workers[0]->tasks.push_back(SearchPath());
+    workers[0]->queued = 1;
+
+    vector<thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back(&ParallelSolver::run, this, ref(*worker));
+    }
+    {
+        // 等待搜索结束，期间转发外部取消标志（工作线程只检查内部的cancel）
+        unique_lock<mutex> lock(stateMutex);
+        while (!finished) {
+            queueChanged.wait_for(lock, chrono::milliseconds(10));
+            if (!finished && externalCancel && externalCancel->load(memory_order_relaxed)) {
+                cancelRequested = true;
+                finished = true;
+                cancel = true;
+                queueChanged.notify_all();
+            }
+        }
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    stats = SolverStats();
+    for (const auto& worker : workers) {
+        nodes += worker->solver->nodeCount();
+        steals += worker->steals;
+        stats.merge(worker->solver->statistics());
+    }
+    return solutionFound;
+}
+
+void ParallelSolver::run(Worker& worker) {
+    SearchPath path;
+    while (takeTask(worker, path)) {
+        bool found = worker.solver->searchSubtree(path);
+        if (found || worker.solver->timedOut()) {
+            finish(worker, found);
+        }
+    }
+}
+
+bool ParallelSolver::popTask(Worker& queue, bool fromFront, SearchPath& path) {
+    // 先无锁看一眼，空队列不必加锁
+    if (queue.queued.load(memory_order_relaxed) == 0) return false;
+    lock_guard<mutex> lock(queue.taskMutex);
+    if (queue.tasks.empty()) return false;
+    if (fromFront) {
+        path = move(queue.tasks.front());
+        queue.tasks.pop_front();
+    } else {
+        path = move(queue.tasks.back());
+        queue.tasks.pop_back();
+    }
+    queue.queued--;
+    return true;
+}
+
+bool ParallelSolver::takeTask(Worker& worker, SearchPath& path) {
+    int count = (int)workers.size();
+    while (true) {
+        if (finished) return false;
+
+        unsigned long long version = taskVersion.load();
+        if (popTask(worker, false, path)) return true;
+        for (int offset = 1; offset < count; offset++) {
+            if (popTask(*workers[(worker.index + offset) % count], true, path)) {
+                worker.steals++;
+                return true;
+            }
+        }
+
+        unique_lock<mutex> lock(stateMutex);
+        if (finished) return false;
+        // 扫描期间有线程放入了任务：重新扫描，不能就此空闲等待
+        if (taskVersion.load() != version) continue;
+        // 没有任何任务且所有线程都空闲：没有线程还能放入任务，整棵树已经搜索完，无解
+        if (++idleWorkers == count) {
+            finished = true;
+            queueChanged.notify_all();
+            return false;
+        }
+        queueChanged.wait(lock);
+        idleWorkers--;
+    }
+}
+
+void ParallelSolver::finish(Worker& worker, bool found) {
+    lock_guard<mutex> lock(stateMutex);
+    if (found && !solutionFound) {
+        solutionFound = true;
+        solutionBoard = worker.solver->solution();
+    }
+    if (worker.solver->timedOut()) {
+        timeout = true;
+    }
+    finished = true;
+    cancel = true;
+    queueChanged.notify_all();
+}
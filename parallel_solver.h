@@ -0,0 +1,73 @@
+#pragma once
+
+#include "puzzle_solver.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+// 并行求解器：每个线程有自己的BitboardSolver（独立的棋盘、放置栈和置换表），互不共享棋盘
+// 有线程空闲时，正在搜索的线程把浅层还没探索的分支（从根到该分支的放置路径）放进自己的任务队列，
+// 线程优先从自己队列的尾部取任务，自己的队列为空时从其他线程队列的头部窃取
+// （头部是最早放入、离根最近的子树，通常也最大）；任一线程找到解后取消所有线程
+// 每个队列有自己的锁，放入、取出和窃取只锁涉及的那一个队列；
+// stateMutex只在线程空闲等待、唤醒空闲线程和结束搜索时使用
+class ParallelSolver {
+public:
+    // threadCount <= 0 时使用硬件线程数；options.transpositionMegabytes为所有线程的总预算
+    ParallelSolver(const PlacementTable& table, const SolverOptions& options, int threadCount = 0);
+
+    // counts按pieceId匹配放置表中的图块类型；timeLimitSeconds <= 0 表示不限时
+    bool solve(const std::vector<PieceCount>& counts, double timeLimitSeconds);
+
+    // 外部取消标志：被置为true后所有线程尽快停止（调用solve()的线程每10毫秒检查一次）
+    void setCancelFlag(const std::atomic<bool>* cancel) { externalCancel = cancel; }
+
+    bool timedOut() const { return timeout; }
+    bool cancelled() const { return cancelRequested; }
+    long long nodeCount() const { return nodes; }
+    long long stealCount() const { return steals; }
+    int threadCount() const { return (int)workers.size(); }
+    // 所有线程的计数器之和（耗时取最长的线程）
+    const SolverStats& statistics() const { return stats; }
+    // 解的棋盘（单元格为pieceId，0为空），仅在solve()返回true后有效
+    const std::vector<std::vector<int>>& solution() const { return solutionBoard; }
+
+private:
+    struct Worker : public SubtreeSplitter {
+        ParallelSolver* owner;
+        int index;
+        std::unique_ptr<BitboardSolver> solver;
+        std::mutex taskMutex;
+        std::deque<SearchPath> tasks;  // 由taskMutex保护
+        std::atomic<int> queued;       // tasks.size()，供hungry()无锁读取
+        long long steals;              // 本线程从其他队列窃取的任务数（只由本线程修改）
+
+        bool hungry() const override;
+        void donate(const SearchPath& path) override;
+    };
+
+    void run(Worker& worker);
+    bool takeTask(Worker& worker, SearchPath& path);
+    bool popTask(Worker& queue, bool fromFront, SearchPath& path);
+    void finish(Worker& worker, bool found);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex stateMutex;
+    std::condition_variable queueChanged;
+    std::atomic<int> idleWorkers;
+    // 每次放入任务时加1（在stateMutex内）：线程扫描完所有队列后，若它没有变化，扫描期间就没有新任务
+    std::atomic<unsigned long long> taskVersion;
+    std::atomic<bool> cancel;
+    const std::atomic<bool>* externalCancel;
+    std::atomic<bool> finished;  // 找到解、超时、被取消或所有线程都空闲且没有剩余任务（在stateMutex内修改）
+    bool timeout;
+    bool cancelRequested;
+    bool solutionFound;
+    long long nodes;
+    long long steals;
+    SolverStats stats;
+    std::vector<std::vector<int>> solutionBoard;
+};
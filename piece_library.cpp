@@ -0,0 +1,86 @@
+#include "piece_library.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+vector<pair<int, int>> rotateShape(const vector<pair<int, int>>& shape) {
+    vector<pair<int, int>> rotated;
+    for (const auto& cell : shape) {
+        // 90度顺时针旋转：(x, y) -> (y, -x)
+        rotated.push_back({cell.second, -cell.first});
+    }
+    // 归一化到原点
+    int minRow = rotated[0].first, minCol = rotated[0].second;
+    for (const auto& cell : rotated) {
+        minRow = min(minRow, cell.first);
+        minCol = min(minCol, cell.second);
+    }
+    for (auto& cell : rotated) {
+        cell.first -= minRow;
+        cell.second -= minCol;
+    }
+    return rotated;
+}
+
+vector<SolverPiece> standardPieces() {
+    vector<SolverPiece> pieces;
+    for (const StandardPiece& definition : STANDARD_PIECES) {
+        SolverPiece piece{definition.name, {}, definition.id};
+        for (int s = 0; s < definition.shapeCount; s++) {
+            const StandardShape& shape = definition.shapes[s];
+            piece.shapes.emplace_back(shape.cells, shape.cells + shape.cellCount);
+        }
+        pieces.push_back(piece);
+    }
+    return pieces;
+}
+
+const SolverPiece* findPieceByName(const vector<SolverPiece>& pieces, const string& name) {
+    for (const auto& piece : pieces) {
+        if (piece.name == name) return &piece;
+    }
+    return nullptr;
+}
+
+bool parsePieceCounts(const string& text, const vector<SolverPiece>& pieces, vector<PieceCount>& counts,
+                      string& error) {
+    counts.clear();
+    for (const auto& piece : pieces) {
+        counts.push_back({piece.id, 0, 0});
+    }
+    istringstream iss(text);
+    string item;
+    while (iss >> item) {
+        size_t colon = item.rfind(':');
+        if (colon == string::npos || colon == 0) {
+            error = "expected name:count, got \"" + item + "\"";
+            return false;
+        }
+        string name = item.substr(0, colon);
+        const SolverPiece* piece = findPieceByName(pieces, name);
+        if (!piece) {
+            error = "unknown piece \"" + name + "\"";
+            return false;
+        }
+        int count = 0;
+        try {
+            size_t used = 0;
+            count = stoi(item.substr(colon + 1), &used);
+            if (used != item.size() - colon - 1) throw invalid_argument(item);
+        } catch (const exception&) {
+            error = "bad count in \"" + item + "\"";
+            return false;
+        }
+        if (count < 0) {
+            error = "negative count in \"" + item + "\"";
+            return false;
+        }
+        for (auto& pc : counts) {
+            if (pc.pieceId == piece->id) pc.count += count;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "puzzle_solver.h"
+
+// 游戏的标准图块库（GUI和批量求解工具共用，不依赖SFML）
+// 图块形状定义中的坐标是相对于基准点（baseRow, baseCol）的偏移量：
+// - 基准点是图块的参考点，不一定是图块占据的第一个单元格
+// - 如果形状在(0,0)位置为空（例如 cross 形状），基准点位置可以放置其他图块
+// - 所有形状定义都应该归一化到至少有一个单元格的行或列为0，但不要求(0,0)位置必须被占据
+// - 放置图块时，实际单元格位置 = (baseRow + cell.first, baseCol + cell.second)
+
+// 旋转图块形状（90度顺时针），结果归一化到原点
+std::vector<std::pair<int, int>> rotateShape(const std::vector<std::pair<int, int>>& shape);
+
+// 标准图块的形状在编译期给出（放置表也在编译期由它们生成，见standard_placements.h）
+struct StandardShape {
+    int cellCount;
+    std::pair<int, int> cells[9];
+};
+
+struct StandardPiece {
+    const char* name;
+    int id;
+    int shapeCount;
+    StandardShape shapes[4];  // 重复的方向（例如2x4的四个方向中两两相同）保留，与GUI中旋转的顺序一致
+};
+
+const int STANDARD_PIECE_COUNT = 15;
+
+// 15种标准图块，id为1..15，顺序即GUI中的显示顺序
+inline constexpr StandardPiece STANDARD_PIECES[STANDARD_PIECE_COUNT] = {
+    // 1. 3x3 正方形
+    {"3x3", 1, 1,
+     {{9, {{0,0}, {0,1}, {0,2}, {1,0}, {1,1}, {1,2}, {2,0}, {2,1}, {2,2}}}}},
+    // 2. 3x3L (横向减少两格，从7格变为5格)
+    {"3x3L", 2, 4,
+     {{5, {{0,0}, {1,0}, {2,0}, {2,1}, {2,2}}},
+      {5, {{0,0}, {0,1}, {0,2}, {1,0}, {2,0}}},
+      {5, {{0,0}, {0,1}, {0,2}, {1,2}, {2,2}}},
+      {5, {{0,2}, {1,2}, {2,0}, {2,1}, {2,2}}}}},
+    // 3. 2x4
+    {"2x4", 3, 4,
+     {{8, {{0,0}, {0,1}, {0,2}, {0,3}, {1,0}, {1,1}, {1,2}, {1,3}}},
+      {8, {{0,0}, {0,1}, {1,0}, {1,1}, {2,0}, {2,1}, {3,0}, {3,1}}},
+      {8, {{0,0}, {0,1}, {0,2}, {0,3}, {1,0}, {1,1}, {1,2}, {1,3}}},
+      {8, {{0,0}, {0,1}, {1,0}, {1,1}, {2,0}, {2,1}, {3,0}, {3,1}}}}},
+    // 4. 2x3
+    {"2x3", 4, 4,
+     {{6, {{0,0}, {0,1}, {0,2}, {1,0}, {1,1}, {1,2}}},
+      {6, {{0,0}, {1,0}, {2,0}, {0,1}, {1,1}, {2,1}}},
+      {6, {{0,0}, {0,1}, {0,2}, {1,0}, {1,1}, {1,2}}},
+      {6, {{0,0}, {1,0}, {2,0}, {0,1}, {1,1}, {2,1}}}}},
+    // 5. L-shape (第二列的格子下一行)：基础形状（0度）依次用rotateShape顺时针旋转90度
+    {"L-shape", 5, 4,
+     {{4, {{0,0}, {1,0}, {2,0}, {2,1}}},
+      {4, {{0,2}, {0,1}, {0,0}, {1,0}}},
+      {4, {{2,1}, {1,1}, {0,1}, {0,0}}},
+      {4, {{1,0}, {1,1}, {1,2}, {0,2}}}}},
+    // 6. L-mirror (L-shape的水平镜像，垂直L，底部向左（┘形状），不能通过旋转L-shape得到)
+    {"L-mirror", 6, 4,
+     {{4, {{0,1}, {1,1}, {2,0}, {2,1}}},
+      {4, {{1,2}, {1,1}, {0,0}, {1,0}}},
+      {4, {{2,0}, {1,0}, {0,1}, {0,0}}},
+      {4, {{0,0}, {0,1}, {1,2}, {0,2}}}}},
+    // 7. L3
+    {"L3", 7, 4,
+     {{3, {{0,1}, {1,0}, {1,1}}},
+      {3, {{0,0}, {1,0}, {1,1}}},
+      {3, {{0,0}, {0,1}, {1,0}}},
+      {3, {{0,0}, {0,1}, {1,1}}}}},
+    // 8. Z-mirror
+    {"Z-mirror", 8, 4,
+     {{4, {{0,0}, {0,1}, {1,1}, {1,2}}},
+      {4, {{0,1}, {1,0}, {1,1}, {2,0}}},
+      {4, {{0,0}, {0,1}, {1,1}, {1,2}}},
+      {4, {{0,1}, {1,0}, {1,1}, {2,0}}}}},
+    // 9. Z-shape (Z-mirror的镜像，水平翻转)
+    {"Z-shape", 9, 4,
+     {{4, {{0,1}, {0,2}, {1,0}, {1,1}}},
+      {4, {{0,0}, {1,0}, {1,1}, {2,1}}},
+      {4, {{0,1}, {0,2}, {1,0}, {1,1}}},
+      {4, {{0,0}, {1,0}, {1,1}, {2,1}}}}},
+    // 10. line4
+    {"line4", 10, 2,
+     {{4, {{0,0}, {0,1}, {0,2}, {0,3}}},
+      {4, {{0,0}, {1,0}, {2,0}, {3,0}}}}},
+    // 11. cross
+    {"cross", 11, 1,
+     {{5, {{0,1}, {1,0}, {1,1}, {1,2}, {2,1}}}}},
+    // 12. T-shape
+    {"T-shape", 12, 4,
+     {{4, {{0,0}, {0,1}, {0,2}, {1,1}}},
+      {4, {{0,2}, {1,1}, {1,2}, {2,2}}},
+      {4, {{1,1}, {2,0}, {2,1}, {2,2}}},
+      {4, {{0,0}, {1,0}, {1,1}, {2,0}}}}},
+    // 13. line3
+    {"line3", 13, 4,
+     {{3, {{0,0}, {0,1}, {0,2}}},
+      {3, {{0,0}, {1,0}, {2,0}}},
+      {3, {{0,0}, {0,1}, {0,2}}},
+      {3, {{0,0}, {1,0}, {2,0}}}}},
+    // 14. 1x1-1
+    {"1x1-1", 14, 1,
+     {{1, {{0,0}}}}},
+    // 15. line2
+    {"line2", 15, 4,
+     {{2, {{0,0}, {0,1}}},
+      {2, {{0,0}, {1,0}}},
+      {2, {{0,0}, {0,1}}},
+      {2, {{0,0}, {1,0}}}}},
+};
+
+// STANDARD_PIECES转换成求解器使用的图块列表
+std::vector<SolverPiece> standardPieces();
+
+// 按名称查找图块（找不到时返回nullptr）
+const SolverPiece* findPieceByName(const std::vector<SolverPiece>& pieces, const std::string& name);
+
+// 解析"名称:数量"列表（空格分隔，例如"cross:4 1x1-1:44"），counts按pieces的顺序排列（与GUI的pieceCounts相同），
+// 同名多次出现时累加；格式错误、未知图块或数量为负时返回false，error为原因
+bool parsePieceCounts(const std::string& text, const std::vector<SolverPiece>& pieces,
+                      std::vector<PieceCount>& counts, std::string& error);
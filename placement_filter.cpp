@@ -0,0 +1,194 @@
+#include "placement_filter.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if !defined(PUZZLE_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define PLACEMENT_FILTER_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define PLACEMENT_FILTER_AVX2 0
+#endif
+
+using namespace std;
+
+namespace {
+
+typedef int (*FilterFunction)(const uint64_t* masks, int count, uint64_t occupied, int* out);
+
+#if PLACEMENT_FILTER_AVX2
+
+// GCC/Clang只给这一个函数启用AVX2，其余代码仍按默认指令集编译；MSVC不需要编译选项
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+// 一组4个掩码的不重叠标志（4位）-> 存活者在组内的下标（排在前面，其余位置会被后面的写入覆盖）
+struct CompressTable {
+    alignas(16) int32_t offsets[16][4];
+    int survivors[16];
+
+    CompressTable() {
+        for (int bits = 0; bits < 16; bits++) {
+            int n = 0;
+            for (int k = 0; k < 4; k++) {
+                if (bits & (1 << k)) offsets[bits][n++] = k;
+            }
+            survivors[bits] = n;
+            while (n < 4) {
+                offsets[bits][n++] = 0;
+            }
+        }
+    }
+};
+
+const CompressTable compressTable;
+
+bool cpuSupportsAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    // 还要求操作系统保存YMM寄存器（OSXSAVE且XCR0的第1、2位）
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return false;
+    if ((_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+AVX2_TARGET int filterAvx2(const uint64_t* masks, int count, uint64_t occupied, int* out) {
+    const __m256i occupiedMask = _mm256_set1_epi64x((long long)occupied);
+    const __m256i zero = _mm256_setzero_si256();
+    int n = 0;
+    int i = 0;
+
+    // 每次8个掩码（两组）：AND后与0比较得到不重叠标志，按标志查表整组写入4个索引，
+    // 只把写入位置前移存活的个数（分支只依赖循环次数，不依赖数据）
+    for (; i + 8 <= count; i += 8) {
+        __m256i low = _mm256_loadu_si256((const __m256i*)(masks + i));
+        __m256i high = _mm256_loadu_si256((const __m256i*)(masks + i + 4));
+        __m256i lowFree = _mm256_cmpeq_epi64(_mm256_and_si256(low, occupiedMask), zero);
+        __m256i highFree = _mm256_cmpeq_epi64(_mm256_and_si256(high, occupiedMask), zero);
+        int lowBits = _mm256_movemask_pd(_mm256_castsi256_pd(lowFree));
+        int highBits = _mm256_movemask_pd(_mm256_castsi256_pd(highFree));
+
+        __m128i lowIndices = _mm_add_epi32(_mm_set1_epi32(i),
+                                           _mm_load_si128((const __m128i*)compressTable.offsets[lowBits]));
+        _mm_storeu_si128((__m128i*)(out + n), lowIndices);
+        n += compressTable.survivors[lowBits];
+
+        __m128i highIndices = _mm_add_epi32(_mm_set1_epi32(i + 4),
+                                            _mm_load_si128((const __m128i*)compressTable.offsets[highBits]));
+        _mm_storeu_si128((__m128i*)(out + n), highIndices);
+        n += compressTable.survivors[highBits];
+    }
+    for (; i < count; i++) {
+        if (!(masks[i] & occupied)) out[n++] = i;
+    }
+    return n;
+}
+
+// 用固定种子的随机掩码比较向量实现与逐个测试的实现：
+// 不同的占用密度（全空到几乎全满）和各种长度（包括不足一组的尾部）
+bool matchesScalar(FilterFunction filter) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    const int maxCount = 75;
+    vector<uint64_t> masks(maxCount);
+    vector<int> expected(maxCount);
+    vector<int> actual(maxCount);
+    for (int round = 0; round < 400; round++) {
+        for (auto& mask : masks) {
+            mask = next() & next() & next();
+        }
+        uint64_t occupied = next();
+        for (int k = 0; k < round % 4; k++) {
+            occupied &= next();
+        }
+        if (round % 50 == 0) occupied = 0;
+        int count = round % (maxCount + 1);
+
+        int expectedCount = filterFreePlacementsScalar(masks.data(), count, occupied, expected.data());
+        int actualCount = filter(masks.data(), count, occupied, actual.data());
+        if (actualCount != expectedCount ||
+            !equal(expected.begin(), expected.begin() + expectedCount, actual.begin())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif  // PLACEMENT_FILTER_AVX2
+
+bool avx2Rejected = false;
+
+FilterFunction selectFilter() {
+#if PLACEMENT_FILTER_AVX2
+    if (cpuSupportsAvx2()) {
+        if (matchesScalar(filterAvx2)) return filterAvx2;
+        // 正常情况下不会发生（placement_filter_test会先失败），发生时不能悄悄地换成慢的实现
+        avx2Rejected = true;
+        cerr << "placement filter: AVX2 kernel disagrees with the scalar filter, falling back to scalar\n";
+    }
+#endif
+    return filterFreePlacementsScalar;
+}
+
+FilterFunction activeFilter() {
+    static const FilterFunction filter = selectFilter();
+    return filter;
+}
+
+}  // namespace
+
+int filterFreePlacementsScalar(const uint64_t* masks, int count, uint64_t occupied, int* out) {
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (!(masks[i] & occupied)) out[n++] = i;
+    }
+    return n;
+}
+
+int filterFreePlacements(const uint64_t* masks, int count, uint64_t occupied, int* out) {
+    return activeFilter()(masks, count, occupied, out);
+}
+
+bool placementFilterAvx2Supported() {
+#if PLACEMENT_FILTER_AVX2
+    static const bool supported = cpuSupportsAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+int filterFreePlacementsAvx2(const uint64_t* masks, int count, uint64_t occupied, int* out) {
+#if PLACEMENT_FILTER_AVX2
+    return filterAvx2(masks, count, occupied, out);
+#else
+    // 没有编译AVX2实现（调用方应先检查placementFilterAvx2Supported()）
+    return filterFreePlacementsScalar(masks, count, occupied, out);
+#endif
+}
+
+const char* placementFilterName() {
+    if (activeFilter() != filterFreePlacementsScalar) return "avx2";
+    return avx2Rejected ? "scalar (avx2 self-check failed)" : "scalar";
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// 候选放置过滤：从一组连续存放的放置掩码中找出不与占用掩码重叠的放置，
+// 把它们的索引按原顺序紧凑地写入out
+// CPU支持AVX2时每条指令测试4个掩码（每次循环8个），否则逐个测试；
+// 向量实现的正确性由placement_filter_test（ctest）保证；首次调用时仍用固定的随机数据比较一次两种实现，
+// 只作为保险：结果不一致时在stderr报告并只使用逐个测试的实现
+// 定义PUZZLE_NO_SIMD时（CMake选项PUZZLE_SIMD_FILTER=OFF）不编译AVX2实现
+
+// 返回写入out的索引个数；索引为masks中的下标，out至少要有count个位置
+// （向量实现整组写入4个索引，但写入位置不会超过当前组的末尾）
+int filterFreePlacements(const uint64_t* masks, int count, uint64_t occupied, int* out);
+
+// 逐个测试的实现（也用于校验向量实现）
+int filterFreePlacementsScalar(const uint64_t* masks, int count, uint64_t occupied, int* out);
+
+// AVX2实现是否已编译且当前CPU支持；为false时不能调用filterFreePlacementsAvx2()
+bool placementFilterAvx2Supported();
+
+// 直接调用AVX2实现（不经过首次调用时的自检，供测试比较两种实现）
+int filterFreePlacementsAvx2(const uint64_t* masks, int count, uint64_t occupied, int* out);
+
+// 当前使用的实现名称（"avx2"、"scalar"，或自检失败时的"scalar (avx2 self-check failed)"）
+const char* placementFilterName();
@@ -0,0 +1,99 @@
+// 测试：候选放置过滤的AVX2实现与逐个测试的实现输出完全相同（由ctest运行，失败时返回1）
+//
+// 比较两组数据：固定种子的随机掩码（各种长度和占用密度），以及真实的放置表
+// （规则棋盘和不规则棋盘上每种图块的masks，占用掩码为随机子集和由真实放置拼出的局面）
+// CPU不支持AVX2或构建时关闭了PUZZLE_SIMD_FILTER时返回77，ctest把它记为跳过
+
+#include "puzzle_solver.h"
+#include "placement_filter.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const int SKIPPED = 77;
+
+uint64_t xorShift(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// 比较一次过滤的结果；不一致时打印出错的输入
+bool sameOutput(const char* what, const vector<uint64_t>& masks, int count, uint64_t occupied) {
+    vector<int> expected(max(count, 1));
+    vector<int> actual(max(count, 1));
+    int expectedCount = filterFreePlacementsScalar(masks.data(), count, occupied, expected.data());
+    int actualCount = filterFreePlacementsAvx2(masks.data(), count, occupied, actual.data());
+    if (actualCount == expectedCount && equal(expected.begin(), expected.begin() + expectedCount, actual.begin())) {
+        return true;
+    }
+    cout << "FAIL " << what << ": count " << count << ", occupied " << hex << occupied << dec << ", scalar "
+         << expectedCount << " survivors, avx2 " << actualCount << "\n";
+    return false;
+}
+
+bool randomMasks() {
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    const int maxCount = 131;
+    vector<uint64_t> masks(maxCount);
+    for (int round = 0; round < 20000; round++) {
+        for (auto& mask : masks) {
+            mask = xorShift(state);
+            for (int k = 0; k < round % 3; k++) {
+                mask &= xorShift(state);
+            }
+        }
+        uint64_t occupied = xorShift(state);
+        for (int k = 0; k < round % 5; k++) {
+            occupied &= xorShift(state);
+        }
+        if (round % 97 == 0) occupied = 0;
+        if (round % 89 == 0) occupied = FULL_BOARD_MASK;
+        if (!sameOutput("random masks", masks, round % (maxCount + 1), occupied)) return false;
+    }
+    return true;
+}
+
+bool placementTable(BoardMask blocked) {
+    const PlacementTable table = buildPlacementTable(blocked);
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ blocked;
+    for (int round = 0; round < 500; round++) {
+        // 用真实放置拼出一个局面：依次尝试随机的放置，不重叠就放上
+        BoardMask occupied = blocked;
+        int pieces = (int)(xorShift(state) % 16);
+        for (int k = 0; k < pieces; k++) {
+            const auto& masks = table.masks[xorShift(state) % table.masks.size()];
+            if (masks.empty()) continue;
+            BoardMask mask = masks[xorShift(state) % masks.size()];
+            if (!(mask & occupied)) occupied |= mask;
+        }
+        if (round % 2) occupied |= xorShift(state) & xorShift(state) & xorShift(state);
+
+        for (const auto& masks : table.masks) {
+            if (!sameOutput("placement table", masks, (int)masks.size(), occupied)) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!placementFilterAvx2Supported()) {
+        cout << "AVX2 filter not available on this CPU or build, skipped\n";
+        return SKIPPED;
+    }
+
+    bool ok = randomMasks();
+    ok = placementTable(0) && ok;
+    // 四角和中间的2x2被挡住
+    ok = placementTable(0x8100001818000081ULL) && ok;
+    cout << (ok ? "avx2 filter matches scalar filter\n" : "avx2 filter differs from scalar filter\n");
+    return ok ? 0 : 1;
+}
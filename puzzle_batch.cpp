@@ -0,0 +1,322 @@
+// 无界面的批量求解工具（不依赖SFML）：从文件或标准输入读取多组图块数量，
+// 在线程池上并行求解，按输入顺序输出每组的结果
+//
+// 用法：puzzle_batch [选项] [输入文件]（没有输入文件或为"-"时读标准输入）
+//   --threads N       工作线程数（默认为硬件线程数）
+//   --time-limit S    每组的时间限制（秒，默认60，0表示不限时）
+//   --engine NAME     cell（默认）、most-constrained、piece、exact-cover、sat
+//   --blocked HEX     被挡住的格子（8x8棋盘的十六进制掩码，第 row * 8 + col 位）
+//   --size N          棋盘尺寸：8（默认）或6、10、12
+//                     只有8x8使用完整的求解器（各引擎、不规则棋盘，与GUI相同）；其他尺寸只能用
+//                     BoardSolver<N>（按最低空格分支的简化搜索，没有置换表和奇偶剪枝），不能与--engine、--blocked同时使用
+//   --cache PATH      结果缓存文件：已求解过的组直接输出缓存的结果（节点数为0），新的确定结果写回该文件
+//   --cache-size N    缓存最多保存的组数（默认10000，超出时淘汰最久没有用到的）
+//
+// 输入：每行一组"名称:数量"，用空格分隔，例如"cross:4 1x1-1:44"；空行和#开头的行被忽略
+// 输出：每组一行，制表符分隔：行号、状态（SOLVED、UNSAT、TIMEOUT、INVALID）、耗时（秒）、节点数、解
+// 解的各行用/连接，每格一个字符：图块id的36进制数字，空格（被挡住的格子）为'.'；
+// INVALID时最后一列为错误原因
+// 前面的组还没求解完时，后面已完成的结果先保存，等前面的组输出后立即输出
+
+#include "puzzle_solver.h"
+#include "piece_library.h"
+#include "board_solver.h"
+#include "solver_engine.h"
+#include "solution_cache.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+struct BatchOptions {
+    int threads = 0;
+    double timeLimit = 60.0;
+    ToolEngine engine = TOOL_ENGINE_CELL;
+    BoardMask blocked = 0;
+    int size = BOARD_SIZE;
+    string inputPath;
+    string cachePath;
+    size_t cacheSize = 10000;
+};
+
+// 一组输入：解析失败时error非空，不求解
+struct BatchJob {
+    int lineNumber;
+    vector<PieceCount> counts;
+    string error;
+};
+
+// 任务列表（只读）+ 按输入顺序排列的结果；工作线程按顺序领取任务，主线程按顺序输出结果
+struct Pipeline {
+    vector<BatchJob> jobs;
+    double timeLimit = 0.0;
+    // 结果缓存（没有--cache时为nullptr）及缓存键需要的棋盘信息
+    SolutionCache* cache = nullptr;
+    const vector<SolverPiece>* pieces = nullptr;
+    int size = BOARD_SIZE;
+    BoardMask blocked = 0;
+    string engineName;
+    mutex taskMutex;
+    size_t nextJob = 0;              // 由taskMutex保护
+    mutex resultMutex;
+    condition_variable resultReady;
+    vector<string> results;          // 由resultMutex保护
+    vector<bool> finished;           // 由resultMutex保护
+    int statusCounts[4] = {0, 0, 0, 0};  // SOLVED、UNSAT、TIMEOUT、INVALID的组数，由resultMutex保护
+    int cacheHits = 0;                   // 由resultMutex保护
+};
+
+enum JobStatus { STATUS_SOLVED, STATUS_UNSAT, STATUS_TIMEOUT, STATUS_INVALID };
+
+const char* statusName(JobStatus status) {
+    switch (status) {
+        case STATUS_SOLVED: return "SOLVED";
+        case STATUS_UNSAT: return "UNSAT";
+        case STATUS_TIMEOUT: return "TIMEOUT";
+        default: return "INVALID";
+    }
+}
+
+void printUsage() {
+    cerr << "usage: puzzle_batch [--threads N] [--time-limit S] [--engine cell|most-constrained|piece|exact-cover|sat]\n"
+            "                    [--blocked HEX] [--size 6|8|10|12] [--cache PATH] [--cache-size N] [input-file]\n"
+            "input: one configuration per line, e.g. \"cross:4 1x1-1:44\" (# starts a comment)\n"
+            "sizes other than 8 use a simplified lowest-empty-cell search only: no --engine, no --blocked\n";
+}
+
+bool parseArguments(int argc, char* argv[], BatchOptions& options) {
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--threads" && hasValue) {
+                options.threads = stoi(argv[++i]);
+            } else if (arg == "--time-limit" && hasValue) {
+                options.timeLimit = stod(argv[++i]);
+            } else if (arg == "--engine" && hasValue) {
+                if (!parseToolEngine(argv[++i], options.engine)) return false;
+            } else if (arg == "--blocked" && hasValue) {
+                options.blocked = stoull(argv[++i], nullptr, 16);
+            } else if (arg == "--size" && hasValue) {
+                options.size = stoi(argv[++i]);
+            } else if (arg == "--cache" && hasValue) {
+                options.cachePath = argv[++i];
+            } else if (arg == "--cache-size" && hasValue) {
+                options.cacheSize = stoul(argv[++i]);
+            } else if (arg == "--help" || arg == "-h") {
+                return false;
+            } else if (options.inputPath.empty() && (arg == "-" || arg[0] != '-')) {
+                options.inputPath = arg;
+            } else {
+                return false;
+            }
+        }
+    } catch (const exception&) {
+        // stoi/stod/stoul/stoull遇到非数字
+        return false;
+    }
+    if (options.size != 6 && options.size != 8 && options.size != 10 && options.size != 12) return false;
+    if (options.size != BOARD_SIZE && (options.blocked != 0 || options.engine != TOOL_ENGINE_CELL)) return false;
+    return true;
+}
+
+bool readJobs(istream& input, const vector<SolverPiece>& pieces, vector<BatchJob>& jobs) {
+    string line;
+    int lineNumber = 0;
+    while (getline(input, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (first == string::npos || line[first] == '#') continue;
+
+        BatchJob job;
+        job.lineNumber = lineNumber;
+        parsePieceCounts(line, pieces, job.counts, job.error);
+        jobs.push_back(job);
+    }
+    return !input.bad();
+}
+
+void publish(Pipeline& pipeline, size_t index, JobStatus status, const string& line, bool cached = false) {
+    lock_guard<mutex> lock(pipeline.resultMutex);
+    pipeline.results[index] = line;
+    pipeline.finished[index] = true;
+    pipeline.statusCounts[status]++;
+    if (cached) pipeline.cacheHits++;
+    pipeline.resultReady.notify_one();
+}
+
+bool takeJob(Pipeline& pipeline, size_t& index) {
+    lock_guard<mutex> lock(pipeline.taskMutex);
+    if (pipeline.nextJob >= pipeline.jobs.size()) return false;
+    index = pipeline.nextJob++;
+    return true;
+}
+
+// 一个工作线程：用自己的求解器实例依次求解领到的组（放置表等只读数据由所有线程共享）
+template <typename Solver>
+void runJobs(Solver& solver, Pipeline& pipeline) {
+    size_t index;
+    while (takeJob(pipeline, index)) {
+        const BatchJob& job = pipeline.jobs[index];
+        ostringstream oss;
+        oss << job.lineNumber << '\t';
+        if (!job.error.empty()) {
+            oss << statusName(STATUS_INVALID) << "\t0\t0\t" << job.error;
+            publish(pipeline, index, STATUS_INVALID, oss.str());
+            continue;
+        }
+
+        auto start = chrono::steady_clock::now();
+        oss.precision(4);
+        CachedSolve cached;
+        if (pipeline.cache &&
+            pipeline.cache->lookup(*pipeline.pieces, pipeline.size, pipeline.blocked, job.counts, cached)) {
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            JobStatus status = cached.solvable ? STATUS_SOLVED : STATUS_UNSAT;
+            oss << statusName(status) << '\t' << fixed << elapsed.count() << "\t0\t";
+            if (cached.solvable) {
+                oss << encodeSolutionGrid(cached.grid);
+            }
+            publish(pipeline, index, status, oss.str(), true);
+            continue;
+        }
+
+        bool found = solver.solve(job.counts, pipeline.timeLimit);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        JobStatus status = found ? STATUS_SOLVED : (solver.timedOut() ? STATUS_TIMEOUT : STATUS_UNSAT);
+        oss << statusName(status) << '\t' << fixed << elapsed.count() << '\t' << solver.nodeCount() << '\t';
+        if (found) {
+            oss << encodeSolutionGrid(solver.solution());
+        }
+        // 超时的组没有确定的结果，不写入缓存
+        if (pipeline.cache && status != STATUS_TIMEOUT) {
+            CachedSolve result;
+            result.solvable = found;
+            if (found) result.grid = solver.solution();
+            result.nodes = solver.nodeCount();
+            result.seconds = elapsed.count();
+            result.engine = pipeline.engineName;
+            pipeline.cache->store(*pipeline.pieces, pipeline.size, pipeline.blocked, job.counts, result);
+        }
+        publish(pipeline, index, status, oss.str());
+    }
+}
+
+void workerMain(const BatchOptions& options, const PlacementTable& table, Pipeline& pipeline) {
+    // 其他尺寸：BoardSolver<N>使用编译期生成的该尺寸的放置表（只支持完整棋盘和按最低空格分支）
+    switch (options.size) {
+        case 6: {
+            BoardSolver<6> solver;
+            runJobs(solver, pipeline);
+            return;
+        }
+        case 10: {
+            BoardSolver<10> solver;
+            runJobs(solver, pipeline);
+            return;
+        }
+        case 12: {
+            BoardSolver<12> solver;
+            runJobs(solver, pipeline);
+            return;
+        }
+        default:
+            break;
+    }
+
+    withToolSolver(options.engine, table, [&pipeline](auto& solver) { runJobs(solver, pipeline); });
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BatchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    vector<SolverPiece> pieces = standardPieces();
+    Pipeline pipeline;
+    pipeline.timeLimit = options.timeLimit;
+    bool readOk;
+    if (options.inputPath.empty() || options.inputPath == "-") {
+        readOk = readJobs(cin, pieces, pipeline.jobs);
+    } else {
+        ifstream file(options.inputPath);
+        if (!file.is_open()) {
+            cerr << "puzzle_batch: cannot open " << options.inputPath << "\n";
+            return 1;
+        }
+        readOk = readJobs(file, pieces, pipeline.jobs);
+    }
+    if (!readOk) {
+        cerr << "puzzle_batch: error reading input\n";
+        return 1;
+    }
+    pipeline.results.assign(pipeline.jobs.size(), string());
+    pipeline.finished.assign(pipeline.jobs.size(), false);
+
+    unique_ptr<SolutionCache> cache;
+    if (!options.cachePath.empty()) {
+        cache.reset(new SolutionCache(options.cachePath, options.cacheSize));
+        cache->load();
+        pipeline.cache = cache.get();
+        pipeline.pieces = &pieces;
+        pipeline.size = options.size;
+        pipeline.blocked = options.blocked;
+        pipeline.engineName = options.size == BOARD_SIZE ? toolEngineName(options.engine)
+                                                         : "board-" + to_string(options.size);
+    }
+
+    // 放置表只生成一次，所有工作线程只读共享
+    const PlacementTable table = buildPlacementTable(options.blocked);
+
+    int threadCount = options.threads > 0 ? options.threads : (int)max(1u, thread::hardware_concurrency());
+    threadCount = min(threadCount, max(1, (int)pipeline.jobs.size()));
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(workerMain, cref(options), cref(table), ref(pipeline));
+    }
+
+    cout << "# line\tstatus\tseconds\tnodes\tsolution\n";
+    for (size_t i = 0; i < pipeline.jobs.size(); i++) {
+        string line;
+        {
+            unique_lock<mutex> lock(pipeline.resultMutex);
+            pipeline.resultReady.wait(lock, [&pipeline, i]() { return pipeline.finished[i]; });
+            line.swap(pipeline.results[i]);
+        }
+        cout << line << '\n';
+        cout.flush();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (cache && !cache->save()) {
+        cerr << "puzzle_batch: cannot write " << options.cachePath << "\n";
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cerr << pipeline.jobs.size() << " configurations on " << threadCount << " threads in " << elapsed.count()
+         << "s: " << pipeline.statusCounts[STATUS_SOLVED] << " solved, " << pipeline.statusCounts[STATUS_UNSAT]
+         << " unsolvable, " << pipeline.statusCounts[STATUS_TIMEOUT] << " timed out, "
+         << pipeline.statusCounts[STATUS_INVALID] << " invalid";
+    if (cache) {
+        cerr << ", " << pipeline.cacheHits << " from cache";
+    }
+    cerr << "\n";
+    return 0;
+}
@@ -0,0 +1,342 @@
+// 求解器基准测试（不依赖SFML）：用固定语料（benchmark_corpus.txt）比较不同引擎和不同构建的求解速度
+//
+// 用法：puzzle_benchmark [选项]
+//   --corpus PATH      语料文件（默认为源码目录中的benchmark_corpus.txt）
+//   --engine NAME      cell、most-constrained、piece、exact-cover、sat或all（默认all，逐个引擎运行）
+//   --repeat N         每组重复求解的次数，取中位数（默认5）
+//   --time-limit S     每次求解的时间限制（秒，默认30）
+//   --category NAME    只运行某一类别
+//   --output PATH      把每组的结果写成制表符分隔的文件，便于不同构建之间比较
+//
+// 每次求解都用新构造的求解器（置换表不会把上一次的结果带到下一次），只计solve()的时间
+// 报告每个类别中各组找到第一个解（或证明无解）的时间的中位数和百分位数、每秒节点数和进程的峰值内存；
+// 结果与语料中的预期不一致时返回1
+
+#include "puzzle_solver.h"
+#include "piece_library.h"
+#include "placement_filter.h"
+#include "solver_engine.h"
+#include "solver_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef PUZZLE_DEFAULT_CORPUS
+#define PUZZLE_DEFAULT_CORPUS "benchmark_corpus.txt"
+#endif
+
+using namespace std;
+
+namespace {
+
+struct BenchmarkOptions {
+    string corpusPath = PUZZLE_DEFAULT_CORPUS;
+    vector<ToolEngine> engines;
+    int repeat = 5;
+    double timeLimit = 30.0;
+    string category;
+    string outputPath;
+};
+
+// 语料中的一组
+struct CorpusEntry {
+    string category;
+    string name;
+    bool expectSolvable;
+    vector<PieceCount> counts;
+};
+
+struct Corpus {
+    int version = 0;
+    vector<CorpusEntry> entries;
+};
+
+enum RunStatus { RUN_SOLVED, RUN_UNSAT, RUN_TIMEOUT };
+
+// 一组在一个引擎上的结果（repeat次求解）
+struct EntryResult {
+    RunStatus status = RUN_UNSAT;
+    vector<double> seconds;  // 每次求解的耗时，已排序
+    long long nodes = 0;     // 最后一次求解的节点数（搜索是确定的，每次相同）
+
+    double medianSeconds() const { return seconds[seconds.size() / 2]; }
+    bool mismatched(bool expectSolvable) const {
+        return status != RUN_TIMEOUT && (status == RUN_SOLVED) != expectSolvable;
+    }
+};
+
+const char* statusName(RunStatus status) {
+    switch (status) {
+        case RUN_SOLVED: return "sat";
+        case RUN_UNSAT: return "unsat";
+        default: return "timeout";
+    }
+}
+
+void printUsage() {
+    cerr << "usage: puzzle_benchmark [--corpus PATH] [--engine cell|most-constrained|piece|exact-cover|sat|all]\n"
+            "                        [--repeat N] [--time-limit S] [--category NAME] [--output PATH]\n";
+}
+
+bool parseArguments(int argc, char* argv[], BenchmarkOptions& options) {
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (i + 1 >= argc) return false;
+            string value = argv[++i];
+            if (arg == "--corpus") {
+                options.corpusPath = value;
+            } else if (arg == "--engine") {
+                ToolEngine engine;
+                if (value == "all") {
+                    options.engines.clear();
+                } else if (parseToolEngine(value, engine)) {
+                    options.engines.push_back(engine);
+                } else {
+                    return false;
+                }
+            } else if (arg == "--repeat") {
+                options.repeat = stoi(value);
+            } else if (arg == "--time-limit") {
+                options.timeLimit = stod(value);
+            } else if (arg == "--category") {
+                options.category = value;
+            } else if (arg == "--output") {
+                options.outputPath = value;
+            } else {
+                return false;
+            }
+        }
+    } catch (const exception&) {
+        // stoi/stod遇到非数字
+        return false;
+    }
+    if (options.engines.empty()) {
+        for (int e = 0; e < TOOL_ENGINE_COUNT; e++) {
+            options.engines.push_back((ToolEngine)e);
+        }
+    }
+    return options.repeat > 0;
+}
+
+// 语料格式：version=N，之后每行"类别 名称 sat|unsat 名称:数量..."；空行和#开头的行被忽略
+bool loadCorpus(const string& path, const vector<SolverPiece>& pieces, Corpus& corpus, string& error) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (first == string::npos || line[first] == '#') continue;
+        if (line.compare(first, 8, "version=") == 0) {
+            corpus.version = atoi(line.c_str() + first + 8);
+            continue;
+        }
+
+        istringstream iss(line);
+        CorpusEntry entry;
+        string expected, rest;
+        iss >> entry.category >> entry.name >> expected;
+        getline(iss, rest);
+        string countError;
+        if ((expected != "sat" && expected != "unsat") || !parsePieceCounts(rest, pieces, entry.counts, countError)) {
+            error = path + ":" + to_string(lineNumber) + ": " + (countError.empty() ? "expected sat or unsat" : countError);
+            return false;
+        }
+        entry.expectSolvable = (expected == "sat");
+        corpus.entries.push_back(entry);
+    }
+    if (corpus.version <= 0) {
+        error = path + ": missing version=";
+        return false;
+    }
+    return true;
+}
+
+EntryResult runEntry(ToolEngine engine, const PlacementTable& table, const CorpusEntry& entry,
+                     const BenchmarkOptions& options) {
+    EntryResult result;
+    for (int run = 0; run < options.repeat; run++) {
+        withToolSolver(engine, table, [&](auto& solver) {
+            auto start = chrono::steady_clock::now();
+            bool found = solver.solve(entry.counts, options.timeLimit);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            result.seconds.push_back(elapsed.count());
+            result.nodes = solver.nodeCount();
+            result.status = found ? RUN_SOLVED : (solver.timedOut() ? RUN_TIMEOUT : RUN_UNSAT);
+        });
+        // 超时的组再重复也只是同样超时
+        if (result.status == RUN_TIMEOUT) break;
+    }
+    sort(result.seconds.begin(), result.seconds.end());
+    return result;
+}
+
+// 最近秩百分位数（sorted已排序，不为空）
+double percentile(const vector<double>& sorted, double p) {
+    size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+    return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// 进程的峰值常驻内存（字节），取不到时为0
+size_t peakMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+string buildDescription() {
+    ostringstream oss;
+#if defined(__clang__)
+    oss << "clang " << __clang_major__ << "." << __clang_minor__;
+#elif defined(__GNUC__)
+    oss << "gcc " << __GNUC__ << "." << __GNUC_MINOR__;
+#elif defined(_MSC_VER)
+    oss << "msvc " << _MSC_VER;
+#endif
+    oss << ", filter " << placementFilterName() << ", stats " << (SOLVER_STATS_ENABLED ? "on" : "off");
+    return oss.str();
+}
+
+// 一个类别（或全部）的汇总行
+void printSummaryRow(const string& label, const vector<const CorpusEntry*>& entries,
+                     const vector<const EntryResult*>& results) {
+    int solved = 0, unsat = 0, timeouts = 0, mismatches = 0;
+    double totalNodes = 0.0, totalSeconds = 0.0;
+    vector<double> medians;
+    for (size_t i = 0; i < results.size(); i++) {
+        const EntryResult& result = *results[i];
+        if (result.status == RUN_SOLVED) solved++;
+        else if (result.status == RUN_UNSAT) unsat++;
+        else timeouts++;
+        if (result.mismatched(entries[i]->expectSolvable)) mismatches++;
+        medians.push_back(result.medianSeconds());
+        totalNodes += (double)result.nodes;
+        totalSeconds += result.medianSeconds();
+    }
+    sort(medians.begin(), medians.end());
+    cout << left << setw(16) << label << right << setw(6) << results.size() << setw(7) << solved << setw(7) << unsat
+         << setw(9) << timeouts << setw(10) << mismatches << fixed << setprecision(3)
+         << setw(12) << percentile(medians, 50) * 1000.0 << setw(10) << percentile(medians, 90) * 1000.0
+         << setw(10) << percentile(medians, 99) * 1000.0 << setw(10) << medians.back() * 1000.0
+         << setw(10) << setprecision(2) << (totalSeconds > 0.0 ? totalNodes / totalSeconds / 1e6 : 0.0) << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    vector<SolverPiece> pieces = standardPieces();
+    Corpus corpus;
+    string error;
+    if (!loadCorpus(options.corpusPath, pieces, corpus, error)) {
+        cerr << "puzzle_benchmark: " << error << "\n";
+        return 2;
+    }
+    vector<const CorpusEntry*> selected;
+    for (const auto& entry : corpus.entries) {
+        if (options.category.empty() || entry.category == options.category) selected.push_back(&entry);
+    }
+    if (selected.empty()) {
+        cerr << "puzzle_benchmark: no configurations selected\n";
+        return 2;
+    }
+
+    ofstream output;
+    if (!options.outputPath.empty()) {
+        output.open(options.outputPath);
+        if (!output.is_open()) {
+            cerr << "puzzle_benchmark: cannot write " << options.outputPath << "\n";
+            return 2;
+        }
+        output << "# corpus-version=" << corpus.version << " repeat=" << options.repeat << " build=" << buildDescription()
+               << "\n";
+        output << "engine\tcategory\tname\texpected\tstatus\tmedian_s\tmin_s\tmax_s\tnodes\tnodes_per_s\n";
+    }
+
+    const PlacementTable table = buildPlacementTable();
+    vector<string> categories;
+    for (const CorpusEntry* entry : selected) {
+        if (find(categories.begin(), categories.end(), entry->category) == categories.end()) {
+            categories.push_back(entry->category);
+        }
+    }
+
+    int totalMismatches = 0;
+    for (ToolEngine engine : options.engines) {
+        vector<EntryResult> results;
+        for (const CorpusEntry* entry : selected) {
+            results.push_back(runEntry(engine, table, *entry, options));
+            const EntryResult& result = results.back();
+            if (result.mismatched(entry->expectSolvable)) {
+                totalMismatches++;
+                cerr << "MISMATCH " << toolEngineName(engine) << " " << entry->name << ": expected "
+                     << (entry->expectSolvable ? "sat" : "unsat") << ", got " << statusName(result.status) << "\n";
+            }
+            if (output.is_open()) {
+                double median = result.medianSeconds();
+                output << toolEngineName(engine) << '\t' << entry->category << '\t' << entry->name << '\t'
+                       << (entry->expectSolvable ? "sat" : "unsat") << '\t' << statusName(result.status) << '\t'
+                       << setprecision(6) << fixed << median << '\t' << result.seconds.front() << '\t'
+                       << result.seconds.back() << '\t' << result.nodes << '\t' << setprecision(0)
+                       << (median > 0.0 ? result.nodes / median : 0.0) << '\n';
+            }
+        }
+
+        cout << "engine " << toolEngineName(engine) << " (corpus v" << corpus.version << ", " << selected.size()
+             << " configurations, " << options.repeat << " runs each, " << buildDescription() << ")\n";
+        cout << left << setw(16) << "category" << right << setw(6) << "count" << setw(7) << "sat" << setw(7) << "unsat"
+             << setw(9) << "timeout" << setw(10) << "mismatch" << setw(12) << "p50(ms)" << setw(10) << "p90(ms)"
+             << setw(10) << "p99(ms)" << setw(10) << "max(ms)" << setw(10) << "Mnodes/s" << "\n";
+        vector<const CorpusEntry*> allEntries;
+        vector<const EntryResult*> allResults;
+        for (const string& category : categories) {
+            vector<const CorpusEntry*> entries;
+            vector<const EntryResult*> categoryResults;
+            for (size_t i = 0; i < selected.size(); i++) {
+                if (selected[i]->category != category) continue;
+                entries.push_back(selected[i]);
+                categoryResults.push_back(&results[i]);
+            }
+            printSummaryRow(category, entries, categoryResults);
+            allEntries.insert(allEntries.end(), entries.begin(), entries.end());
+            allResults.insert(allResults.end(), categoryResults.begin(), categoryResults.end());
+        }
+        printSummaryRow("all", allEntries, allResults);
+        // 峰值内存是整个进程到目前为止的最大值，比较内存时应每次只运行一个引擎
+        cout << "peak memory: " << setprecision(1) << peakMemoryBytes() / (1024.0 * 1024.0) << " MB\n\n";
+    }
+    return totalMismatches > 0 ? 1 : 0;
+}
@@ -6,12 +6,22 @@
 #include <sstream>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <fstream>
 #include <tuple>
 #include <functional>
 #include <set>
+#include "puzzle_solver.h"
+#include "piece_library.h"
+#include "exact_cover_solver.h"
+#include "sat_tiling_solver.h"
+#include "placement_filter.h"
+#include "parallel_solver.h"
+#include "resumable_solver.h"
+#include "solve_worker.h"
+#include "solution_cache.h"
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -20,8 +30,7 @@
 using namespace std;
 using namespace sf;
 
-// 8x8游戏板
-const int BOARD_SIZE = 8;
+// 8x8游戏板（BOARD_SIZE定义在puzzle_solver.h中）
 const int CELL_SIZE = 60;
 const int WINDOW_WIDTH = 1800;
 const int WINDOW_HEIGHT = 1000;
@@ -32,25 +41,22 @@ vector<vector<int>> board(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
 vector<vector<int>> solutionBoard(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
 bool solved = false;
 bool showSolution = false;
+// 保护solutionBoard和solveGeneration：求解线程发布结果、界面线程开始/取消求解和复制要绘制的棋盘时持有
 mutex boardMutex;
+atomic<bool> solutionPending(false);  // 求解线程已把解发布到solutionBoard，等待界面线程应用到board
 
 // 求解计时器相关（全局变量，供drawBoard访问）
-bool solving = false;  // 是否正在求解
-bool solutionFound = false;  // 是否找到解
+atomic<bool> solving(false);  // 是否正在求解（求解线程写完所有结果后才清除）
+atomic<bool> solutionFound(false);  // 是否找到解
 Clock solveTimer;  // 求解计时器
 float solveTime = 0.0f;  // 求解时间（秒）
-thread* solveThread = nullptr;  // 求解线程
-bool solveTimeout = false;  // 求解超时标志
-int solveCheckCount = 0;  // 求解调用计数器（用于超时检查）
-float estimatedSolveTime = 120.0f;  // 预估求解时间（秒），默认120秒
-
-// 图块数量编辑器相关
-struct PieceCount {
-    int pieceId;
-    int count;
-    int currentShapeIndex;
-};
+SolveWorker* solveWorker = nullptr;  // 常驻的求解线程（在main中创建）
+int solveGeneration = 0;  // 每次开始或取消求解时加1，只有编号仍是最新的任务才发布结果
+atomic<bool> solveTimeout(false);  // 求解超时标志（由求解线程在任务开始时清除）
+float estimatedSolveTime = 120.0f;  // 上次求解的时间限制（秒，由求解线程按预估的搜索树大小设定）
+string solverStatsText;  // 上次求解的统计信息（置换表命中率、并行线程数等，没有时为空）
 
+// 图块数量编辑器相关（PieceCount定义在puzzle_solver.h中）
 vector<PieceCount> pieceCounts;  // 每种图块的数量
 bool showEditor = false;  // 是否显示编辑器
 int selectedPieceType = -1;  // 选中的图块类型（用于编辑器）
@@ -98,6 +104,57 @@ struct Piece {
 
 vector<Piece> pieces;
 vector<pair<int, int>> piecePositions;
+PlacementTable placementTable;  // 所有图块的预计算放置掩码（由rebuildPlacementTable生成）
+// 被挡住的格子（不规则棋盘的缺口和洞）：不能放图块，也不需要被填满
+// 只在求解线程空闲时修改（求解线程读取placementTable和canPlace()），修改后重建放置表
+BoardMask blockedCells = 0;
+
+bool isBlockedCell(int row, int col) {
+    return (blockedCells & cellBit(row, col)) != 0;
+}
+
+// 求解引擎
+enum SolverEngine {
+    ENGINE_BITBOARD_CELL,     // 位棋盘 + 预计算放置表（按最低空格分支）
+    ENGINE_MOST_CONSTRAINED,  // 按候选放置最少的空格分支，被迫的放置直接放下
+    ENGINE_PARALLEL,          // 按最低空格分支，多线程拆分子树并行搜索
+    ENGINE_RESUMABLE,         // 显式栈搜索，超时后再次求解从暂停处继续（状态保存在检查点文件中）
+    ENGINE_BITBOARD,          // 位棋盘 + 预计算放置表（按图块类型分支）
+    ENGINE_EXACT_COVER,       // 精确覆盖（Dancing Links，图块数量作为多重性列）
+    ENGINE_SAT,               // 编码为CNF，用内置CDCL求解器求解（适合回溯难以穷举的无解组合）
+    ENGINE_CLASSIC,           // 原逐格检查的solve()
+    ENGINE_COUNT
+};
+SolverEngine solverEngine = ENGINE_BITBOARD_CELL;  // 只由界面线程读写（求解线程使用SolveJob中的副本）
+
+// 并行引擎的线程数（T键切换），0为硬件线程数；只由界面线程读写
+int parallelThreadSetting = 0;
+
+int parallelThreadCount() {
+    return parallelThreadSetting > 0 ? parallelThreadSetting : (int)max(1u, thread::hardware_concurrency());
+}
+
+// 一次求解使用的引擎设置：界面线程在提交任务时按当时的solverEngine和线程数生成一份副本，
+// 求解线程只读这份副本，之后按B键或T键切换不影响已经提交的任务
+struct EngineSettings {
+    SolverEngine engine;
+    SolverOptions options;  // BitboardSolver类引擎的选项；其他引擎预估时间时用作代替的搜索树
+    int threads;            // 并行引擎的线程数
+};
+
+const char* solverEngineName(SolverEngine engine) {
+    switch (engine) {
+        case ENGINE_BITBOARD_CELL: return "Bitboard (Cell)";
+        case ENGINE_MOST_CONSTRAINED: return "Bitboard (Most Constrained)";
+        case ENGINE_PARALLEL: return "Parallel (Cell)";
+        case ENGINE_RESUMABLE: return "Resumable (Cell)";
+        case ENGINE_BITBOARD: return "Bitboard (Piece)";
+        case ENGINE_EXACT_COVER: return "Exact Cover";
+        case ENGINE_SAT: return "SAT (CDCL)";
+        case ENGINE_CLASSIC: return "Classic";
+        default: return "";
+    }
+}
 
 // 颜色数组
 Color colors[] = {
@@ -119,197 +176,22 @@ Color colors[] = {
     Color(176, 224, 230)    // 粉蓝
 };
 
-// 旋转图块形状（90度顺时针）
-vector<pair<int, int>> rotateShape(const vector<pair<int, int>>& shape) {
-    vector<pair<int, int>> rotated;
-    for (const auto& cell : shape) {
-        // 90度顺时针旋转：(x, y) -> (y, -x)
-        rotated.push_back({cell.second, -cell.first});
-    }
-    // 归一化到原点
-    int minRow = rotated[0].first, minCol = rotated[0].second;
-    for (const auto& cell : rotated) {
-        minRow = min(minRow, cell.first);
-        minCol = min(minCol, cell.second);
-    }
-    for (auto& cell : rotated) {
-        cell.first -= minRow;
-        cell.second -= minCol;
-    }
-    return rotated;
+// 取出所有图块在当前棋盘形状上的放置掩码，求解时只需查表（blockedCells改变后调用）
+// 图块与pieces相同，都来自standardPieces()
+void rebuildPlacementTable() {
+    placementTable = buildPlacementTable(blockedCells);
 }
 
-// 初始化所有图块定义
-// 重要说明：图块形状定义中的坐标是相对于基准点（baseRow, baseCol）的偏移量
-// - 基准点是图块的参考点，不一定是图块占据的第一个单元格
-// - 如果形状在(0,0)位置为空（例如 cross 形状），基准点位置可以放置其他图块
-// - 所有形状定义都应该归一化到至少有一个单元格的行或列为0，但不要求(0,0)位置必须被占据
-// - 放置图块时，实际单元格位置 = (baseRow + cell.first, baseCol + cell.second)
+// 初始化所有图块定义（形状坐标的约定见piece_library.h）
 void initializePieces() {
     pieces.clear();
     piecePositions.clear();
     
+    // 形状定义在piece_library.cpp中（批量求解工具共用），这里按顺序配上颜色
     int colorIndex = 0;
-    
-    // 1. 3x3 正方形
-    pieces.push_back({
-        "3x3",
-        {{{0,0}, {0,1}, {0,2}, {1,0}, {1,1}, {1,2}, {2,0}, {2,1}, {2,2}}},
-        1,
-        colors[colorIndex++]
-    });
-    
-    // 2. 3x3L (横向减少两格，从7格变为5格)
-    pieces.push_back({
-        "3x3L",
-        {{{0,0}, {1,0}, {2,0}, {2,1}, {2,2}},
-         {{0,0}, {0,1}, {0,2}, {1,0}, {2,0}},
-         {{0,0}, {0,1}, {0,2}, {1,2}, {2,2}},
-         {{0,2}, {1,2}, {2,0}, {2,1}, {2,2}}},
-        2,
-        colors[colorIndex++]
-    });
-    
-    // 3. 2x4
-    pieces.push_back({
-        "2x4",
-        {{{0,0}, {0,1}, {0,2}, {0,3}, {1,0}, {1,1}, {1,2}, {1,3}},
-         {{0,0}, {0,1}, {1,0}, {1,1}, {2,0}, {2,1}, {3,0}, {3,1}},
-         {{0,0}, {0,1}, {0,2}, {0,3}, {1,0}, {1,1}, {1,2}, {1,3}},
-         {{0,0}, {0,1}, {1,0}, {1,1}, {2,0}, {2,1}, {3,0}, {3,1}}},
-        3,
-        colors[colorIndex++]
-    });
-    
-    // 4. 2x3
-    pieces.push_back({
-        "2x3",
-        {{{0,0}, {0,1}, {0,2}, {1,0}, {1,1}, {1,2}},
-         {{0,0}, {1,0}, {2,0}, {0,1}, {1,1}, {2,1}},
-         {{0,0}, {0,1}, {0,2}, {1,0}, {1,1}, {1,2}},
-         {{0,0}, {1,0}, {2,0}, {0,1}, {1,1}, {2,1}}},
-        4,
-        colors[colorIndex++]
-    });
-    
-    // 5. L-shape (第二列的格子下一行)
-    // 基础形状（0度）：L形状
-    vector<pair<int, int>> lShapeBase = {{0,0}, {1,0}, {2,0}, {2,1}};
-    vector<pair<int, int>> lShape90 = rotateShape(lShapeBase);  // 90度
-    vector<pair<int, int>> lShape180 = rotateShape(lShape90);   // 180度
-    vector<pair<int, int>> lShape270 = rotateShape(lShape180);  // 270度
-    pieces.push_back({
-        "L-shape",
-        {lShapeBase, lShape90, lShape180, lShape270},
-        5,
-        colors[colorIndex++]
-    });
-    
-    // 6. L-mirror (L-shape的水平镜像)
-    // L-shape基础：{{0,0}, {1,0}, {2,0}, {2,1}} - 垂直L，底部向右（L形状）
-    // L-mirror基础：{{0,1}, {1,1}, {2,0}, {2,1}} - 垂直L，底部向左（┘形状）
-    // 这是 L-shape 的水平镜像，不能通过旋转 L-shape 得到
-    vector<pair<int, int>> lMirrorBase = {{0,1}, {1,1}, {2,0}, {2,1}};
-    vector<pair<int, int>> lMirror90 = rotateShape(lMirrorBase);   // 90度
-    vector<pair<int, int>> lMirror180 = rotateShape(lMirror90);    // 180度
-    vector<pair<int, int>> lMirror270 = rotateShape(lMirror180);   // 270度
-    pieces.push_back({
-        "L-mirror",
-        {lMirrorBase, lMirror90, lMirror180, lMirror270},
-        6,
-        colors[colorIndex++]
-    });
-    
-    // 7. L3
-    pieces.push_back({
-        "L3",
-        {{{0,1}, {1,0}, {1,1}},
-         {{0,0}, {1,0}, {1,1}},
-         {{0,0}, {0,1}, {1,0}},
-         {{0,0}, {0,1}, {1,1}}},
-        7,
-        colors[colorIndex++]
-    });
-    
-    // 8. Z-mirror
-    pieces.push_back({
-        "Z-mirror",
-        {{{0,0}, {0,1}, {1,1}, {1,2}},
-         {{0,1}, {1,0}, {1,1}, {2,0}},
-         {{0,0}, {0,1}, {1,1}, {1,2}},
-         {{0,1}, {1,0}, {1,1}, {2,0}}},
-        8,
-        colors[colorIndex++]
-    });
-    
-    // 9. Z-shape (Z-mirror的镜像，水平翻转)
-    pieces.push_back({
-        "Z-shape",
-        {{{0,1}, {0,2}, {1,0}, {1,1}},  
-         {{0,0}, {1,0}, {1,1}, {2,1}},
-         {{0,1}, {0,2}, {1,0}, {1,1}},
-         {{0,0}, {1,0}, {1,1}, {2,1}}},
-        9,
-        colors[colorIndex++]
-    });
-    
-    // 10. line4
-    pieces.push_back({
-        "line4",
-        {{{0,0}, {0,1}, {0,2}, {0,3}},
-         {{0,0}, {1,0}, {2,0}, {3,0}}},
-        10,
-        colors[colorIndex++]
-    });
-    
-    // 11. cross
-    pieces.push_back({
-        "cross",
-        {{{0,1}, {1,0}, {1,1}, {1,2}, {2,1}}},
-        11,
-        colors[colorIndex++]
-    });
-    
-    // 12. T-shape
-    pieces.push_back({
-        "T-shape",
-        {{{0,0}, {0,1}, {0,2}, {1,1}},
-         {{0,2}, {1,1}, {1,2}, {2,2}},
-         {{1,1}, {2,0}, {2,1}, {2,2}},
-         {{0,0}, {1,0}, {1,1}, {2,0}}},
-        12,
-        colors[colorIndex++]
-    });
-    
-    // 13. line3
-    pieces.push_back({
-        "line3",
-        {{{0,0}, {0,1}, {0,2}},
-         {{0,0}, {1,0}, {2,0}},
-         {{0,0}, {0,1}, {0,2}},
-         {{0,0}, {1,0}, {2,0}}},
-        13,
-        colors[colorIndex++]
-    });
-    
-    // 14. 1x1-1
-    pieces.push_back({
-        "1x1-1",
-        {{{0,0}}},
-        14,
-        colors[colorIndex++]
-    });
-    
-    // 15. line2
-    pieces.push_back({
-        "line2",
-        {{{0,0}, {0,1}},
-         {{0,0}, {1,0}},
-         {{0,0}, {0,1}},
-         {{0,0}, {1,0}}},
-        15,
-        colors[colorIndex++]
-    });
+    for (const auto& definition : standardPieces()) {
+        pieces.push_back({definition.name, definition.shapes, definition.id, colors[colorIndex++]});
+    }
     
     piecePositions.resize(pieces.size());
     
@@ -333,67 +215,8 @@ void initializePieces() {
         // 其他图块（如Z-mirror、T-shape、L3等）默认为0
         pieceCounts.push_back({piece.id, count, 0});
     }
-}
-
-// 预估求解时间（根据图块组合的复杂度）
-float estimateSolveTime(const vector<PieceCount>& counts) {
-    int totalPieces = 0;
-    int totalCells = 0;
-    int largePieceCount = 0;  // 大图块数量（>=5格）
-    int smallPieceCount = 0;  // 小图块数量（1-2格）
-    int crossCount = 0;  // cross图块数量（搜索空间大）
-    
-    for (const auto& pc : counts) {
-        if (pc.count == 0) continue;
-        
-        // 找到对应的图块
-        const Piece* piece = nullptr;
-        for (const auto& p : pieces) {
-            if (p.id == pc.pieceId) {
-                piece = &p;
-                break;
-            }
-        }
-        
-        if (!piece || piece->shapes.empty()) continue;
-        
-        int pieceSize = (int)piece->shapes[0].size();
-        int count = pc.count;
-        
-        totalPieces += count;
-        totalCells += pieceSize * count;
-        
-        if (piece->name == "cross") {
-            crossCount += count;
-            largePieceCount += count;
-        } else if (pieceSize >= 5) {
-            largePieceCount += count;
-        } else if (pieceSize <= 2) {
-            smallPieceCount += count;
-        }
-    }
     
-    // 基础时间：根据总图块数量
-    float baseTime = 5.0f + totalPieces * 0.5f;
-    
-    // 大图块增加时间（搜索空间大）
-    baseTime += largePieceCount * 15.0f;
-    
-    // cross图块特别耗时（搜索空间很大）
-    baseTime += crossCount * 20.0f;
-    
-    // 小图块（1x1）很多时，如果其他图块少，可能很快
-    if (smallPieceCount > 30 && largePieceCount <= 4) {
-        baseTime = max(baseTime, 30.0f);  // 至少30秒
-    }
-    
-    // 确保最小时间
-    baseTime = max(baseTime, 30.0f);
-    
-    // 最大时间限制（避免过长）
-    baseTime = min(baseTime, 300.0f);  // 最多5分钟
-    
-    return baseTime;
+    rebuildPlacementTable();
 }
 
 // 设置测试用例：4个cross和44个1x1（总计：4×5 + 44×1 = 20 + 44 = 64格）
@@ -424,8 +247,9 @@ void setTestCase2() {
 //   - row, col: 基准点（reference point），不一定是图块占据的第一个单元格
 //   - 注意：如果形状在(0,0)位置为空，基准点位置可以放置其他图块
 //   - ignoreRow, ignoreCol: 忽略的位置（通常是正在拖拽的图块的原始位置）
+//   - grid: 要检查的棋盘，默认为界面上的board（后台求解时为求解线程自己的棋盘）
 bool canPlace(const vector<pair<int, int>>& shape, int row, int col, 
-              int ignoreRow = -1, int ignoreCol = -1) {
+              int ignoreRow = -1, int ignoreCol = -1, const vector<vector<int>>& grid = board) {
     // 只检查形状中实际定义的单元格，不检查基准点本身
     // 如果形状在(0,0)位置为空，基准点位置不会被占用，可以放置其他图块
     for (const auto& cell : shape) {
@@ -442,7 +266,7 @@ bool canPlace(const vector<pair<int, int>>& shape, int row, int col,
             continue;
         }
         
-        if (board[newRow][newCol] != 0) {
+        if (grid[newRow][newCol] != 0 || isBlockedCell(newRow, newCol)) {
             return false;
         }
     }
@@ -454,10 +278,11 @@ bool canPlace(const vector<pair<int, int>>& shape, int row, int col,
 //   - shape: 图块形状，坐标是相对于基准点(row, col)的偏移量
 //   - row, col: 基准点（reference point），不一定是图块占据的第一个单元格
 //   - 注意：只放置形状中实际定义的单元格，如果形状在(0,0)位置为空，基准点位置不会被占用
-void placePiece(const vector<pair<int, int>>& shape, int row, int col, int id) {
+void placePiece(const vector<pair<int, int>>& shape, int row, int col, int id,
+                vector<vector<int>>& grid = board) {
     // 只放置形状中实际定义的单元格，不占用基准点本身
     for (const auto& cell : shape) {
-        board[row + cell.first][col + cell.second] = id;
+        grid[row + cell.first][col + cell.second] = id;
     }
 }
 
@@ -468,10 +293,11 @@ void placePiece(const vector<pair<int, int>>& shape, int row, int col, int id) {
 //   - shape: 图块形状，坐标是相对于基准点(row, col)的偏移量
 //   - row, col: 基准点（reference point），不一定是图块占据的第一个单元格
 //   - 注意：只移除形状中实际定义的单元格，不处理基准点本身
-void removePiece(const vector<pair<int, int>>& shape, int row, int col) {
+void removePiece(const vector<pair<int, int>>& shape, int row, int col,
+                 vector<vector<int>>& grid = board) {
     // 只移除形状中实际定义的单元格
     for (const auto& cell : shape) {
-        board[row + cell.first][col + cell.second] = 0;
+        grid[row + cell.first][col + cell.second] = 0;
     }
 }
 
@@ -959,40 +785,6 @@ void drawPiecePreviewArea(RenderWindow& window, Font& font) {
     }
 }
 
-// 计算指定pieceId的已放置实例数（使用DFS精确计算）
-int countPlacedInstances(int pieceId) {
-    int instanceCount = 0;
-    vector<vector<bool>> counted(BOARD_SIZE, vector<bool>(BOARD_SIZE, false));
-    
-    for (int row = 0; row < BOARD_SIZE; row++) {
-        for (int col = 0; col < BOARD_SIZE; col++) {
-            if (board[row][col] == pieceId && !counted[row][col]) {
-                // 使用DFS找到所有相连的格子（属于同一个图块实例）
-                vector<vector<bool>> visited(BOARD_SIZE, vector<bool>(BOARD_SIZE, false));
-                
-                function<void(int, int)> dfs = [&](int r, int c) {
-                    if (r < 0 || r >= BOARD_SIZE || c < 0 || c >= BOARD_SIZE) return;
-                    if (visited[r][c] || board[r][c] != pieceId) return;
-                    
-                    visited[r][c] = true;
-                    counted[r][c] = true;
-                    
-                    // 检查四个方向的相邻格子
-                    dfs(r - 1, c);
-                    dfs(r + 1, c);
-                    dfs(r, c - 1);
-                    dfs(r, c + 1);
-                };
-                
-                dfs(row, col);
-                instanceCount++;
-            }
-        }
-    }
-    
-    return instanceCount;
-}
-
 // 获取指定pieceId的所有已放置实例的位置和形状信息
 struct PieceInstance {
     int baseRow;
@@ -1133,13 +925,13 @@ void removeExcessInstances(int pieceId, int maxCount) {
 }
 
 // 计算孤立区域数量（用于启发式搜索，检查是否有小于5格的孤立空区域）
-int countSmallIsolatedRegions() {
+int countSmallIsolatedRegions(const vector<vector<int>>& grid = board) {
     vector<vector<bool>> visited(BOARD_SIZE, vector<bool>(BOARD_SIZE, false));
     int smallRegionCount = 0;
     
     function<int(int, int)> dfs = [&](int r, int c) -> int {
         if (r < 0 || r >= BOARD_SIZE || c < 0 || c >= BOARD_SIZE) return 0;
-        if (visited[r][c] || board[r][c] != 0) return 0;
+        if (visited[r][c] || grid[r][c] != 0 || isBlockedCell(r, c)) return 0;
         
         visited[r][c] = true;
         int size = 1;
@@ -1152,7 +944,7 @@ int countSmallIsolatedRegions() {
     
     for (int row = 0; row < BOARD_SIZE; row++) {
         for (int col = 0; col < BOARD_SIZE; col++) {
-            if (!visited[row][col] && board[row][col] == 0) {
+            if (!visited[row][col] && grid[row][col] == 0 && !isBlockedCell(row, col)) {
                 int size = dfs(row, col);
                 if (size > 0 && size < 5) {  // 小于5格的孤立区域（无法放置cross）
                     smallRegionCount++;
@@ -1164,63 +956,78 @@ int countSmallIsolatedRegions() {
     return smallRegionCount;
 }
 
-bool solve(int pieceIndex, const vector<PieceCount>& counts) {
+// solve()的状态：求解用的棋盘（求解线程自己的副本，不是界面上的board）、计时和取消标志，
+// 以及增量状态：每种图块的剩余数量（与counts同序）和已填充的格子数
+// 求解总是从空棋盘开始，剩余数量直接取自counts，之后只由placeTracked/removeTracked更新，
+// 不再从棋盘上的连通块反推已放置的实例（相邻的同种图块会被合并成一个）
+// 每个求解任务有自己的状态（由runSelectedSolver创建），不与界面线程或其他任务共享
+struct ClassicSolveState {
+    vector<vector<int>> grid;
+    Clock timer;
+    double timeLimit;
+    const atomic<bool>* cancel;
+    vector<int> remaining;
+    int filledCells;
+    long long checks = 0;  // 递归调用计数（用于超时检查）
+    SolverStats stats;     // 节点数和耗时总是统计，其余只在定义PUZZLE_SOLVER_STATS时统计
+};
+
+// 在state.grid上搜索（调用方先把起始棋盘复制到state.grid）
+bool solve(ClassicSolveState& state, int pieceIndex, const vector<PieceCount>& counts) {
+    vector<vector<int>>& grid = state.grid;
+    // 根节点：初始化增量状态（棋盘为空，还没有放置任何图块）
+    if (pieceIndex == 0) {
+        state.stats.reset(placementTable.pieces.size());
+        state.filledCells = 0;
+        state.remaining.clear();
+        for (const auto& pc : counts) {
+            state.remaining.push_back(pc.count);
+        }
+    }
+    
     // 检查超时（每200次递归调用检查一次，更频繁的检查）
-    solveCheckCount++;
-    if (solveCheckCount % 200 == 0) {
-        if (solveTimer.getElapsedTime().asSeconds() > estimatedSolveTime) {
+    state.checks++;
+    SOLVER_STATS(state.stats.maxDepth = max(state.stats.maxDepth, pieceIndex));
+    if (state.checks % 200 == 0) {
+        // 被取消时同样设置solveTimeout，让各层循环中的检查尽快退出
+        if (state.timer.getElapsedTime().asSeconds() > state.timeLimit ||
+            state.cancel->load(memory_order_relaxed)) {
             solveTimeout = true;
+            SOLVER_STATS(state.stats.prunes[PRUNE_TIMEOUT]++);
             return false;
         }
     }
     
     if (solveTimeout) {
+        SOLVER_STATS(state.stats.prunes[PRUNE_TIMEOUT]++);
         return false;
     }
     
-    // 快速计算已填充的单元格数（避免重复遍历）
-    int filledCells = 0;
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (board[i][j] != 0) filledCells++;
-        }
-    }
-    
-    // 预先计算所有图块的已放置实例数（避免重复计算）
-    map<int, int> placedCounts;
-    for (const auto& pc : counts) {
-        if (pc.count > 0) {
-            placedCounts[pc.pieceId] = countPlacedInstances(pc.pieceId);
-        }
-    }
+    int filledCells = state.filledCells;
+    vector<int>& remainingCounts = state.remaining;
     
     // 验证每种图块类型的使用数量是否正好等于用户指定的数量（不能多也不能少）
     bool allPiecesUsedCorrectly = true;
-    for (const auto& pc : counts) {
-        int placedCount = 0;
-        if (placedCounts.find(pc.pieceId) != placedCounts.end()) {
-            placedCount = placedCounts[pc.pieceId];
-        }
-        
+    for (int remaining : remainingCounts) {
         // 使用数量必须正好等于用户指定的数量
-        if (placedCount != pc.count) {
+        if (remaining != 0) {
             allPiecesUsedCorrectly = false;
             break;
         }
     }
     
-    // 只有当游戏板填满且所有图块类型都使用了正确的数量时，才认为求解成功
-    if (filledCells == BOARD_SIZE * BOARD_SIZE && allPiecesUsedCorrectly) {
+    // 只有当游戏板（被挡住的格子除外）填满且所有图块类型都使用了正确的数量时，才认为求解成功
+    if (filledCells == placementTable.openCells() && allPiecesUsedCorrectly) {
         return true;
     }
     
     // 剪枝优化：如果剩余空间不足以放置剩余图块，提前返回false
-    int emptyCells = BOARD_SIZE * BOARD_SIZE - filledCells;
+    int emptyCells = placementTable.openCells() - filledCells;
     int requiredCells = 0;
-    for (const auto& pc : counts) {
+    for (size_t c = 0; c < counts.size(); c++) {
+        const PieceCount& pc = counts[c];
         if (pc.count > 0) {
-            int placedCount = placedCounts[pc.pieceId];
-            int remaining = pc.count - placedCount;
+            int remaining = remainingCounts[c];
             if (remaining > 0) {
                 const Piece* piece = nullptr;
                 for (const auto& p : pieces) {
@@ -1237,20 +1044,19 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
         }
     }
     if (requiredCells > emptyCells) {
+        SOLVER_STATS(state.stats.prunes[PRUNE_AREA]++);
         return false;  // 剩余空间不足，剪枝
     }
     
     // 创建一个图块列表，按大小和剩余数量排序（大的先放，剩余数量少的优先）
-    vector<tuple<int, int, int>> pieceList; // {pieceId, size, remaining}
-    for (const auto& pc : counts) {
+    vector<tuple<int, int, int>> pieceList; // {counts中的索引, size, remaining}
+    for (size_t c = 0; c < counts.size(); c++) {
+        const PieceCount& pc = counts[c];
         // 如果数量为0，跳过
         if (pc.count == 0) continue;
         
-        // 使用预先计算的结果
-        int placedCount = placedCounts[pc.pieceId];
-        
         // 如果已经放置了足够的数量，跳过
-        if (placedCount >= pc.count) continue;
+        if (remainingCounts[c] <= 0) continue;
         
         // 找到对应的图块并计算大小
         const Piece* piece = nullptr;
@@ -1265,8 +1071,7 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
         
         // 计算图块大小（使用第一个形状的单元格数）
         int pieceSize = (int)piece->shapes[0].size();
-        int remaining = pc.count - placedCount;
-        pieceList.push_back({pc.pieceId, pieceSize, remaining});
+        pieceList.push_back({(int)c, pieceSize, remainingCounts[c]});
     }
     
     // 如果没有任何可放置的图块，返回false
@@ -1285,17 +1090,9 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
     
     // 尝试放置每种类型的图块（按排序后的顺序）
     for (const auto& item : pieceList) {
-        int pcPieceId = get<0>(item);
-        
-        // 找到对应的PieceCount
-        const PieceCount* pc = nullptr;
-        for (const auto& count : counts) {
-            if (count.pieceId == pcPieceId) {
-                pc = &count;
-                break;
-            }
-        }
-        if (!pc) continue;
+        int countIndex = get<0>(item);
+        const PieceCount* pc = &counts[countIndex];
+        int pcPieceId = pc->pieceId;
         
         // 找到对应的图块
         const Piece* piece = nullptr;
@@ -1334,6 +1131,19 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
         // 获取图块大小（用于优化搜索范围）
         int pieceSize = (int)piece->shapes[0].size();
         
+        // 放置/撤销时同步更新增量状态
+        auto placeTracked = [&](const vector<pair<int, int>>& shape, int row, int col) {
+            SOLVER_STATS(state.stats.placementsTried[placementTable.typeIndexOf(piece->id)]++);
+            placePiece(shape, row, col, piece->id, grid);
+            remainingCounts[countIndex]--;
+            state.filledCells += pieceSize;
+        };
+        auto removeTracked = [&](const vector<pair<int, int>>& shape, int row, int col) {
+            removePiece(shape, row, col, grid);
+            remainingCounts[countIndex]++;
+            state.filledCells -= pieceSize;
+        };
+        
         // 尝试所有唯一形状和位置
         for (const auto& shape : uniqueShapes) {
             if (solveTimeout) return false;
@@ -1355,13 +1165,13 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
             // 优化：对于1x1图块，使用更高效的填充策略（按顺序填充空位）
             if (pieceSize == 1) {
                 // 1x1图块：直接按顺序填充空位，避免重复尝试
-                int remaining1x1 = pc->count - placedCounts[pcPieceId];
+                int remaining1x1 = remainingCounts[countIndex];
                 
                 // 收集所有空位
                 vector<pair<int, int>> emptyCells;
         for (int row = 0; row < BOARD_SIZE; row++) {
             for (int col = 0; col < BOARD_SIZE; col++) {
-                        if (board[row][col] == 0) {
+                        if (grid[row][col] == 0) {
                             emptyCells.push_back({row, col});
                         }
                     }
@@ -1369,32 +1179,33 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
                 
                 // 如果剩余空位少于剩余1x1数量，不可能成功（剪枝）
                 if ((int)emptyCells.size() < remaining1x1) {
+                    SOLVER_STATS(state.stats.prunes[PRUNE_AREA]++);
                     return false;
                 }
                 
                 // 如果空位数量正好等于剩余1x1数量，直接全部填充（这是最优情况）
                 if ((int)emptyCells.size() == remaining1x1) {
                     for (const auto& pos : emptyCells) {
-                        placePiece(shape, pos.first, pos.second, piece->id);
+                        placeTracked(shape, pos.first, pos.second);
                     }
-                    if (solve(pieceIndex + 1, counts)) {
+                    if (solve(state, pieceIndex + 1, counts)) {
                         return true;
                     }
                     // 恢复
                     for (const auto& pos : emptyCells) {
-                        removePiece(shape, pos.first, pos.second);
+                        removeTracked(shape, pos.first, pos.second);
                     }
                 } else {
                     // 按顺序尝试填充（对于大量1x1，这样可以减少递归深度）
                     for (const auto& pos : emptyCells) {
                         if (solveTimeout) return false;
-                        placePiece(shape, pos.first, pos.second, piece->id);
+                        placeTracked(shape, pos.first, pos.second);
                         
-                        if (solve(pieceIndex + 1, counts)) {
+                        if (solve(state, pieceIndex + 1, counts)) {
                             return true;
                         }
                         
-                        removePiece(shape, pos.first, pos.second);
+                        removeTracked(shape, pos.first, pos.second);
                     }
                 }
             } else {
@@ -1405,16 +1216,17 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
                     vector<tuple<int, int, int>> positions; // {score, row, col}
                     for (int row = 0; row < maxRow; row++) {
                         for (int col = 0; col < maxCol; col++) {
-                if (canPlace(shape, row, col)) {
+                SOLVER_STATS(state.stats.placementTests++);
+                if (canPlace(shape, row, col, -1, -1, grid)) {
                                 // 计算启发式分数
                                 int centerRow = BOARD_SIZE / 2;
                                 int centerCol = BOARD_SIZE / 2;
                                 int distFromCenter = abs(row - centerRow) + abs(col - centerCol);
                                 
                                 // 检查放置后是否会产生过小的孤立区域
-                                placePiece(shape, row, col, piece->id);
-                                int smallRegions = countSmallIsolatedRegions();
-                                removePiece(shape, row, col);
+                                placePiece(shape, row, col, piece->id, grid);
+                                int smallRegions = countSmallIsolatedRegions(grid);
+                                removePiece(shape, row, col, grid);
                                 
                                 // 分数：距离中心越近越好，孤立区域越少越好
                                 // 如果产生孤立小区域，大幅增加分数（降低优先级）
@@ -1429,13 +1241,13 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
                         if (solveTimeout) return false;
                         int row = get<1>(pos);
                         int col = get<2>(pos);
-                        placePiece(shape, row, col, piece->id);
+                        placeTracked(shape, row, col);
                         
-                        if (solve(pieceIndex + 1, counts)) {
+                        if (solve(state, pieceIndex + 1, counts)) {
                         return true;
                     }
                     
-                    removePiece(shape, row, col);
+                    removeTracked(shape, row, col);
                 }
                 } else {
                     // 其他大图块：正常搜索
@@ -1444,14 +1256,15 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
                         for (int col = 0; col < maxCol; col++) {
                             if (solveTimeout) return false;
                             
-                            if (canPlace(shape, row, col)) {
-                                placePiece(shape, row, col, piece->id);
+                            SOLVER_STATS(state.stats.placementTests++);
+                            if (canPlace(shape, row, col, -1, -1, grid)) {
+                                placeTracked(shape, row, col);
                                 
-                                if (solve(pieceIndex + 1, counts)) {
+                                if (solve(state, pieceIndex + 1, counts)) {
                                     return true;
                                 }
                                 
-                                removePiece(shape, row, col);
+                                removeTracked(shape, row, col);
                             }
                         }
                     }
@@ -1465,6 +1278,390 @@ bool solve(int pieceIndex, const vector<PieceCount>& counts) {
     return false;
 }
 
+// 一次求解任务：求解线程只读写任务自己的数据，结束时在boardMutex下把结果发布给界面线程
+struct SolveJob {
+    vector<PieceCount> counts;   // pieceCounts的副本，确保求解使用的图块数量与求解开始时一致
+    vector<vector<int>> grid;    // 起始为空棋盘，找到解时为解
+    EngineSettings settings;     // 提交时的引擎设置
+    double timeLimit;            // 时间限制（秒），由求解线程开始时预估
+    string statsText;            // 统计信息（置换表命中率、并行线程数等）
+    long long nodes = 0;         // 搜索的节点数（写入结果缓存）
+};
+
+// 使用基于放置表的求解器求解，解写入job.grid
+template <typename Solver>
+bool runTableSolver(Solver& solver, SolveJob& job, const atomic<bool>& cancel) {
+    solver.setCancelFlag(&cancel);
+    bool found = solver.solve(job.counts, job.timeLimit);
+    job.nodes = solver.nodeCount();
+    if (solver.timedOut()) {
+        solveTimeout = true;
+    }
+    if (found) {
+        job.grid = solver.solution();
+    }
+    return found;
+}
+
+// 按最低空格分支的求解选项（单线程和并行引擎共用）
+SolverOptions cellSolverOptions() {
+    SolverOptions options;
+    options.branching = BRANCH_FIRST_EMPTY;
+    options.breakSymmetry = true;
+    options.pruneRegions = true;
+    options.checkParity = true;
+    options.transpositionMegabytes = 64;
+    return options;
+}
+
+// 按候选放置最少的空格分支的求解选项（ENGINE_MOST_CONSTRAINED）
+SolverOptions mostConstrainedSolverOptions() {
+    SolverOptions options = cellSolverOptions();
+    options.branching = BRANCH_MOST_CONSTRAINED;
+    return options;
+}
+
+// 按图块类型分支的求解选项（ENGINE_BITBOARD）
+SolverOptions pieceSolverOptions() {
+    SolverOptions options;
+    options.breakSymmetry = true;
+    options.orderCopies = true;
+    options.pruneRegions = true;
+    return options;
+}
+
+// 当前选择的引擎设置（只在界面线程调用）
+// 原solve()、精确覆盖和SAT引擎没有对应的BitboardSolver，分别用按图块类型和按最低空格分支的选项代替
+EngineSettings currentEngineSettings() {
+    EngineSettings settings;
+    settings.engine = solverEngine;
+    settings.threads = parallelThreadCount();
+    if (solverEngine == ENGINE_BITBOARD || solverEngine == ENGINE_CLASSIC) {
+        settings.options = pieceSolverOptions();
+    } else if (solverEngine == ENGINE_MOST_CONSTRAINED) {
+        settings.options = mostConstrainedSolverOptions();
+    } else {
+        settings.options = cellSolverOptions();
+    }
+    return settings;
+}
+
+// 预估用settings中的引擎求解需要的时间（秒）：对搜索树做Knuth随机探测（BitboardSolver::estimateTree，
+// 先实际搜索calibrationSeconds秒测量速度），取穷举整棵树的预计时间（找第一个解的时间不会更长）
+// summary非空时写入预估的说明文字
+float estimateSolveTime(const vector<PieceCount>& counts, const EngineSettings& settings, const atomic<bool>* cancel,
+                        string* summary, double calibrationSeconds = 0.1) {
+    SolverOptions options = settings.options;
+    options.transpositionMegabytes = 0;  // 估计的是不计置换表剪枝的树，不需要分配置换表
+    BitboardSolver solver(placementTable, options);
+    solver.setCancelFlag(cancel);
+    TreeEstimate estimate = solver.estimateTree(counts, 2000, calibrationSeconds);
+
+    double seconds = estimate.exhaustSeconds();
+    if (settings.engine == ENGINE_PARALLEL) {
+        seconds /= max(1, settings.threads);
+    }
+    if (summary) {
+        ostringstream oss;
+        if (!estimate.feasible) {
+            oss << "Unsolvable by area or coloring parity";
+        } else if (estimate.exact) {
+            oss << "Search tree: " << (long long)estimate.nodes << " nodes (measured)";
+        } else {
+            oss.precision(2);
+            oss << "Estimated tree: " << estimate.nodes << " nodes (+-"
+                << (int)(estimate.relativeError * 100.0 + 0.5) << "%), ";
+            oss.precision(1);
+            oss << fixed << seconds << "s to exhaust";
+        }
+        *summary = oss.str();
+    }
+    return (float)seconds;
+}
+
+// 求解的时间限制：预估时间的3倍（穷举树的估计误差通常在3倍以内），限制在5~300秒
+float solveTimeLimit(float estimatedSeconds) {
+    return min(300.0f, max(5.0f, estimatedSeconds * 3.0f));
+}
+
+// 测试用例按钮下方显示的预估时间：每种引擎设置和棋盘形状只估计一次（测试用例的图块组合固定）
+// 估计在求解线程上进行，不占用界面线程：求解线程空闲时提交（不抢占正在进行的求解），
+// 被新的求解或Esc取消的估计不保存，求解线程再次空闲时重新提交
+typedef tuple<int, int, int, BoardMask> TestCaseEstimateKey;  // 测试用例、引擎、线程数、被挡住的格子
+mutex testCaseEstimateMutex;
+map<TestCaseEstimateKey, float> testCaseEstimates;  // 由testCaseEstimateMutex保护
+
+// 只在界面线程调用；已有估计时写入seconds并返回true，否则（需要时）提交估计任务并返回false
+bool testCaseEstimate(int testCase, const vector<PieceCount>& counts, float& seconds) {
+    EngineSettings settings = currentEngineSettings();
+    TestCaseEstimateKey key = make_tuple(testCase, (int)settings.engine, settings.threads, blockedCells);
+    {
+        lock_guard<mutex> lock(testCaseEstimateMutex);
+        auto it = testCaseEstimates.find(key);
+        if (it != testCaseEstimates.end()) {
+            seconds = it->second;
+            return true;
+        }
+    }
+    // 求解线程正忙时，之前提交的估计可能还在排队或运行，也不在求解期间插入估计
+    // 求解线程空闲时placementTable不会被修改（H键同样要求求解线程空闲），估计使用的就是key中的棋盘形状
+    if (solveWorker->busy()) return false;
+    solveWorker->submit([key, settings, counts](const atomic<bool>& cancel) {
+        float estimate = estimateSolveTime(counts, settings, &cancel, nullptr, 0.02);
+        if (cancel.load()) return;
+        lock_guard<mutex> lock(testCaseEstimateMutex);
+        testCaseEstimates[key] = estimate;
+    }, false);
+    return false;
+}
+
+// 测试用例按钮下方的预估时间文字，估计结果出来之前显示占位文字
+string testCaseEstimateText(int testCase, const vector<PieceCount>& counts) {
+    float seconds = 0.0f;
+    if (!testCaseEstimate(testCase, counts, seconds)) {
+        return "Est. Time: ...";
+    }
+    ostringstream oss;
+    oss.precision(1);
+    oss << "Est. Time: " << fixed << seconds << "s";
+    return oss.str();
+}
+
+const char* SOLVER_CHECKPOINT_FILE = "solver_checkpoint.txt";
+const char* SOLVER_STATS_FILE = "solver_stats.json";
+
+// 已求解过的图块组合的结果（解或已证明无解），程序重启后仍然有效；再次求解同一组合时直接使用
+SolutionCache solutionCache("solution_cache.txt");
+
+// 把上次求解的计数器写入solver_stats.json（仅在编译时启用PUZZLE_SOLVER_STATS时）
+void exportSolverStats(const SolverStats& stats) {
+#if SOLVER_STATS_ENABLED
+    vector<string> names;
+    for (const auto& piece : placementTable.pieces) {
+        names.push_back(piece.name);
+    }
+    ofstream file(SOLVER_STATS_FILE);
+    if (file.is_open()) {
+        file << stats.toJson(names);
+    }
+#else
+    (void)stats;
+#endif
+}
+
+bool sameCounts(const vector<PieceCount>& a, const vector<PieceCount>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].pieceId != b[i].pieceId || a[i].count != b[i].count) return false;
+    }
+    return true;
+}
+
+// 可恢复引擎：同一组图块数量超时后再次求解时从上次暂停的位置继续，
+// 程序重启后也可以从检查点文件继续
+bool runResumableSolver(SolveJob& job, const atomic<bool>& cancel) {
+    static ResumableSolver solver(placementTable);
+    static bool paused = false;
+    static BoardMask pausedBlocked = 0;  // 暂停时的棋盘形状，改变后放置表的编号也变了
+    const vector<PieceCount>& counts = job.counts;
+
+    if (!paused || !sameCounts(solver.pieceCounts(), counts) || pausedBlocked != placementTable.blocked) {
+        paused = solver.loadCheckpoint(SOLVER_CHECKPOINT_FILE) &&
+                 solver.searchMode() == RESUMABLE_FIRST_SOLUTION &&
+                 sameCounts(solver.pieceCounts(), counts) && solver.depth() > 0;
+        if (!paused && !solver.start(counts, RESUMABLE_FIRST_SOLUTION)) return false;
+    }
+
+    // 被取消时同样暂停并写检查点，下次求解同一组图块时继续
+    solver.setCancelFlag(&cancel);
+    SearchStatus status = solver.run(job.timeLimit, SOLVER_CHECKPOINT_FILE);
+    job.nodes = solver.nodeCount();
+    paused = (status == SEARCH_PAUSED);
+    pausedBlocked = placementTable.blocked;
+    if (paused) {
+        solveTimeout = true;
+        job.statsText = "Paused at depth " + to_string(solver.depth()) + " after " +
+                          to_string(solver.nodeCount()) + " nodes, solve again to resume";
+    }
+    if (status == SEARCH_FOUND) {
+        job.grid = solver.solution();
+    }
+    return status == SEARCH_FOUND;
+}
+
+// 使用任务提交时选择的引擎（job.settings）求解，找到解时写入job.grid；cancel被置位后尽快返回
+// 只读写job和求解器自己的状态，不访问界面上的board和引擎设置，调用方不需要持有boardMutex
+bool runSelectedSolver(SolveJob& job, const atomic<bool>& cancel) {
+    const EngineSettings& settings = job.settings;
+    switch (settings.engine) {
+        case ENGINE_CLASSIC: {
+            ClassicSolveState state;
+            state.grid = job.grid;
+            state.timeLimit = job.timeLimit;
+            state.cancel = &cancel;
+            state.timer.restart();
+            bool found = solve(state, 0, job.counts);
+            if (found) {
+                job.grid = state.grid;
+            }
+            state.stats.nodes = state.checks;
+            job.nodes = state.checks;
+            state.stats.seconds = state.timer.getElapsedTime().asSeconds();
+            exportSolverStats(state.stats);
+            return found;
+        }
+        case ENGINE_EXACT_COVER: {
+            ExactCoverSolver solver(placementTable);
+            return runTableSolver(solver, job, cancel);
+        }
+        case ENGINE_SAT: {
+            SatTilingSolver solver(placementTable);
+            bool found = runTableSolver(solver, job, cancel);
+            const CdclStats& stats = solver.satStatistics();
+            job.statsText = to_string(solver.variableCount()) + " vars, " + to_string(solver.clauseCount()) +
+                            " clauses, " + to_string(stats.conflicts) + " conflicts, " +
+                            to_string(stats.restarts) + " restarts";
+            if (solver.provedUnsatisfiable()) {
+                job.statsText += " (proved unsolvable)";
+            }
+            return found;
+        }
+        case ENGINE_BITBOARD: {
+            BitboardSolver solver(placementTable, settings.options);
+            bool found = runTableSolver(solver, job, cancel);
+            exportSolverStats(solver.statistics());
+            job.statsText = string("Candidate filter: ") + placementFilterName();
+            return found;
+        }
+        case ENGINE_RESUMABLE:
+            return runResumableSolver(job, cancel);
+        case ENGINE_MOST_CONSTRAINED: {
+            BitboardSolver solver(placementTable, settings.options);
+            bool found = runTableSolver(solver, job, cancel);
+            exportSolverStats(solver.statistics());
+            return found;
+        }
+        case ENGINE_PARALLEL: {
+            ParallelSolver solver(placementTable, settings.options, settings.threads);
+            bool found = runTableSolver(solver, job, cancel);
+            exportSolverStats(solver.statistics());
+            job.statsText = to_string(solver.threadCount()) + " threads, " +
+                              to_string(solver.stealCount()) + " subtrees stolen";
+            return found;
+        }
+        default: {
+            BitboardSolver solver(placementTable, settings.options);
+            bool found = runTableSolver(solver, job, cancel);
+            exportSolverStats(solver.statistics());
+
+            const TranspositionStats& stats = solver.transpositionStats();
+            ostringstream oss;
+            oss.precision(1);
+            oss << "Transposition hits: " << stats.hits << ", misses: " << stats.misses()
+                << " (" << fixed << stats.hitRate() * 100.0 << "%)";
+            job.statsText = oss.str();
+            return found;
+        }
+    }
+}
+
+// 统计解数（只计数，不生成棋盘），结果写入job.statsText
+void runSolutionCount(SolveJob& job, const atomic<bool>& cancel) {
+    BitboardSolver solver(placementTable, cellSolverOptions());
+    solver.setCancelFlag(&cancel);
+    long long solutions = solver.enumerate(job.counts, job.timeLimit);
+    job.statsText = (solver.timedOut() ? "Timeout! Solutions found so far: " : "Solutions: ") +
+                    to_string(solutions);
+}
+
+// 把当前棋盘和图块数量交给常驻的求解线程（调用方已重启solveTimer）
+// 正在运行的旧任务被取消，它的结果不再发布；countOnly为true时只统计解数
+// 求解线程搜索期间不持有boardMutex，只在发布结果时短暂持锁，界面线程在下一帧把解应用到board
+void startSolveJob(bool countOnly = false) {
+    SolveJob job;
+    job.counts = pieceCounts;
+    job.settings = currentEngineSettings();
+    // 自动求解和测试用例按钮都先清空了board，求解从空棋盘开始（找到的解整体替换board）
+    job.grid.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
+    int generation;
+    {
+        lock_guard<mutex> lock(boardMutex);
+        generation = ++solveGeneration;
+        solving = true;
+        solutionFound = false;
+        solved = false;
+        solutionPending = false;
+        solveTime = 0.0f;
+    }
+    solveWorker->submit([job, generation, countOnly](const atomic<bool>& cancel) mutable {
+        Clock timer;
+        solveTimeout = false;
+        string estimateText;
+        bool found = false;
+        CachedSolve cached;
+        if (!countOnly && solutionCache.lookup(placementTable.pieces, BOARD_SIZE, placementTable.blocked, job.counts,
+                                               cached)) {
+            // 同一组合已经求解过：不再搜索，显示当时的统计
+            found = cached.solvable;
+            if (found) {
+                job.grid = cached.grid;
+            }
+            job.timeLimit = 0.0;
+            ostringstream oss;
+            oss.precision(2);
+            oss << "Cached: " << (found ? "solved" : "proved unsolvable") << " by " << cached.engine << " in "
+                << fixed << cached.seconds << "s, " << cached.nodes << " nodes";
+            job.statsText = oss.str();
+        } else if (countOnly) {
+            job.timeLimit = solveTimeLimit(estimateSolveTime(job.counts, job.settings, &cancel, &estimateText));
+            runSolutionCount(job, cancel);
+        } else {
+            job.timeLimit = solveTimeLimit(estimateSolveTime(job.counts, job.settings, &cancel, &estimateText));
+            found = runSelectedSolver(job, cancel);
+            // 只缓存确定的结果：超时、暂停或被取消的求解没有结论；
+            // 原逐格检查的solve()在限时内的"无解"不作为证明
+            bool proved = !solveTimeout && !cancel.load() && job.settings.engine != ENGINE_CLASSIC;
+            if (found || proved) {
+                CachedSolve result;
+                result.solvable = found;
+                result.grid = job.grid;
+                result.nodes = job.nodes;
+                result.seconds = timer.getElapsedTime().asSeconds();
+                result.engine = solverEngineName(job.settings.engine);
+                solutionCache.store(placementTable.pieces, BOARD_SIZE, placementTable.blocked, job.counts, result);
+                solutionCache.save();
+            }
+        }
+
+        lock_guard<mutex> lock(boardMutex);
+        // 已被新的求解或Esc取消取代：丢弃结果，显示状态归新任务所有
+        if (generation != solveGeneration) return;
+        if (found) {
+            solutionBoard = job.grid;
+        }
+        solverStatsText = job.statsText.empty() ? estimateText : estimateText + "\n" + job.statsText;
+        estimatedSolveTime = (float)job.timeLimit;
+        solutionFound = found;
+        solved = found;
+        solveTime = timer.getElapsedTime().asSeconds();  // 记录求解时间
+        solutionPending = found;
+        // 最后清除求解标志：界面线程看到solving为false时，以上结果都已写好
+        solving = false;
+    });
+}
+
+// 取消正在进行的求解（Esc键）
+void cancelSolveJob() {
+    {
+        lock_guard<mutex> lock(boardMutex);
+        solveGeneration++;
+        solving = false;
+        solveTime = 0.0f;
+        solverStatsText = "Solve cancelled";
+    }
+    solveWorker->cancel();
+}
+
 void drawBoard(RenderWindow& window, Font& font) {
     int offsetX = 50;
     int offsetY = 50;
@@ -1484,8 +1681,23 @@ void drawBoard(RenderWindow& window, Font& font) {
         window.draw(line2);
     }
     
+    // 被挡住的格子画成深灰色（不属于棋盘）
+    for (BoardMask rest = blockedCells; rest; rest &= rest - 1) {
+        int index = lowestBitIndex(rest);
+        RectangleShape hole(Vector2f(CELL_SIZE - 2, CELL_SIZE - 2));
+        hole.setPosition(offsetX + (index % BOARD_SIZE) * CELL_SIZE + 2,
+                         offsetY + (index / BOARD_SIZE) * CELL_SIZE + 2);
+        hole.setFillColor(Color(70, 70, 70));
+        window.draw(hole);
+    }
+    
     // 绘制图块（使用纹理，按完整形状）
-    lock_guard<mutex> lock(boardMutex);
+    // 只在复制要显示的棋盘时持锁，绘制期间不会阻塞求解线程发布结果
+    vector<vector<int>> shownBoard;
+    {
+        lock_guard<mutex> lock(boardMutex);
+        shownBoard = showSolution ? solutionBoard : board;
+    }
     vector<vector<bool>> drawn(BOARD_SIZE, vector<bool>(BOARD_SIZE, false));
     
     // 先收集所有图块的位置和形状
@@ -1504,7 +1716,7 @@ void drawBoard(RenderWindow& window, Font& font) {
     
     for (int i = 0; i < BOARD_SIZE; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
-            int cellValue = showSolution ? solutionBoard[i][j] : board[i][j];
+            int cellValue = shownBoard[i][j];
             if (cellValue != 0 && !drawn[i][j] && !matchedInThisFrame[i][j]) {
                 const Piece* piece = nullptr;
                 int shapeIndex = -1;
@@ -1557,7 +1769,7 @@ void drawBoard(RenderWindow& window, Font& font) {
                                 matches = false;
                                 break;
                             }
-                            int val = showSolution ? solutionBoard[checkRow][checkCol] : board[checkRow][checkCol];
+                            int val = shownBoard[checkRow][checkCol];
                             if (val != cellValue) {
                                 matches = false;
                                 break;
@@ -1748,7 +1960,6 @@ void drawBoard(RenderWindow& window, Font& font) {
             window.draw(testButton1Text);
             
             // 在测试用例1按钮下方显示预估求解时间
-            float testCase1EstimatedTime = estimateSolveTime(pieceCounts);
             // 临时设置测试用例1的pieceCounts来计算预估时间
             vector<PieceCount> tempCounts1;
             for (const auto& piece : pieces) {
@@ -1757,11 +1968,7 @@ void drawBoard(RenderWindow& window, Font& font) {
                 else if (piece.name == "1x1-1") count = 44;
                 tempCounts1.push_back({piece.id, count, 0});
             }
-            testCase1EstimatedTime = estimateSolveTime(tempCounts1);
-            ostringstream est1Oss;
-            est1Oss.precision(1);
-            est1Oss << fixed << testCase1EstimatedTime;
-            Text estimatedTime1Text("Est. Time: " + est1Oss.str() + "s", font, 12);
+            Text estimatedTime1Text(testCaseEstimateText(1, tempCounts1), font, 12);
             estimatedTime1Text.setPosition(testButton1X, buttonY + buttonHeight + 5);
             estimatedTime1Text.setFillColor(Color(100, 100, 100));  // 灰色
             window.draw(estimatedTime1Text);
@@ -1795,11 +2002,7 @@ void drawBoard(RenderWindow& window, Font& font) {
                 else if (piece.name == "1x1-1") count = 4;
                 tempCounts2.push_back({piece.id, count, 0});
             }
-            float testCase2EstimatedTime = estimateSolveTime(tempCounts2);
-            ostringstream est2Oss;
-            est2Oss.precision(1);
-            est2Oss << fixed << testCase2EstimatedTime;
-            Text estimatedTime2Text("Est. Time: " + est2Oss.str() + "s", font, 12);
+            Text estimatedTime2Text(testCaseEstimateText(2, tempCounts2), font, 12);
             estimatedTime2Text.setPosition(testButton2X, buttonY + buttonHeight + 5);
             estimatedTime2Text.setFillColor(Color(100, 100, 100));  // 灰色
             window.draw(estimatedTime2Text);
@@ -1819,7 +2022,13 @@ void drawBoard(RenderWindow& window, Font& font) {
             "E - Open/Close Editor",
             "Left Click - Drag Piece",
             "Right Click - Rotate/Remove Piece",
-            "Mouse - Drag Editor Window"
+            "Mouse - Drag Editor Window",
+            string("B - Solver Engine: ") + solverEngineName(solverEngine),
+            (parallelThreadSetting > 0 ? "T - Parallel Threads: " : "T - Parallel Threads: Auto, ") +
+                to_string(parallelThreadCount()),
+            "C - Count Solutions",
+            "H - Block/Unblock Cell Under Mouse",
+            "Esc - Cancel Solve"
         };
         
         for (const auto& text : controlTexts) {
@@ -1829,6 +2038,13 @@ void drawBoard(RenderWindow& window, Font& font) {
             window.draw(control);
             controlsY += 20;
         }
+
+        if (!solving && !solverStatsText.empty()) {
+            Text stats(solverStatsText, font, 12);
+            stats.setPosition(buttonX, controlsY);
+            stats.setFillColor(Color(80, 80, 80));
+            window.draw(stats);
+        }
     }
     
     // 绘制拖拽预览
@@ -2430,6 +2646,11 @@ int main() {
     
     initializePieces();
     loadPieceTextures();
+    solutionCache.load();
+    
+    // 常驻的求解线程，main返回时先于全局变量销毁（取消当前任务并等待线程退出）
+    SolveWorker worker;
+    solveWorker = &worker;
     
     for (int i = 0; i < BOARD_SIZE; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
@@ -2445,6 +2666,12 @@ int main() {
     bool mouseRightPressed = false;
     
     while (window.isOpen()) {
+        // 后台求解找到解后，由界面线程把解应用到board（求解线程从不修改board）
+        if (solutionPending.exchange(false)) {
+            lock_guard<mutex> lock(boardMutex);
+            board = solutionBoard;
+        }
+        
         Event event;
         while (window.pollEvent(event)) {
             if (event.type == Event::Closed) {
@@ -2456,6 +2683,49 @@ int main() {
                 if (event.key.code == Keyboard::E) {
                     showEditor = !showEditor;
                 }
+                // B键循环切换求解引擎（求解中不切换）
+                if (event.key.code == Keyboard::B && !solving) {
+                    solverEngine = (SolverEngine)((solverEngine + 1) % ENGINE_COUNT);
+                }
+                // T键切换并行引擎的线程数：自动 -> 1 -> 2 -> 4 ... -> 硬件线程数 -> 自动（求解中不切换）
+                if (event.key.code == Keyboard::T && !solving) {
+                    int hardware = (int)max(1u, thread::hardware_concurrency());
+                    if (parallelThreadSetting == 0) {
+                        parallelThreadSetting = 1;
+                    } else if (parallelThreadSetting >= hardware) {
+                        parallelThreadSetting = 0;
+                    } else {
+                        parallelThreadSetting = min(hardware, parallelThreadSetting * 2);
+                    }
+                }
+                // C键统计当前图块组合的解数（只计数，不生成棋盘，结果显示在按键说明下方）
+                // 正在求解时按下会取消当前求解
+                if (event.key.code == Keyboard::C) {
+                    solveTimer.restart();
+                    startSolveJob(true);
+                }
+                // Esc键取消正在进行的求解
+                if (event.key.code == Keyboard::Escape && solving) {
+                    cancelSolveJob();
+                }
+                // H键切换鼠标下的空格是否被挡住（求解线程空闲时才能修改棋盘形状）
+                if (event.key.code == Keyboard::H && !solveWorker->busy()) {
+                    Vector2i hover = Mouse::getPosition(window);
+                    int row = (hover.y - 50) / CELL_SIZE;
+                    int col = (hover.x - 50) / CELL_SIZE;
+                    if (hover.x >= 50 && hover.y >= 50 && row < BOARD_SIZE && col < BOARD_SIZE &&
+                        board[row][col] == 0) {
+                        blockedCells ^= cellBit(row, col);
+                        rebuildPlacementTable();
+                        // 旧的解是按原来的棋盘形状求出的
+                        lock_guard<mutex> lock(boardMutex);
+                        solved = false;
+                        solutionFound = false;
+                        showSolution = false;
+                        solveTime = 0.0f;
+                        solverStatsText.clear();
+                    }
+                }
             }
             
             // 处理自动求解按钮点击
@@ -2475,15 +2745,8 @@ int main() {
                     if (solutionFound && !solving) {
                         // 如果已找到解且不在求解中，切换显示
                         showSolution = !showSolution;
-                    } else if (!solving) {
-                        // 开始自动求解（允许多次求解）
-                        solving = true;
-                        solutionFound = false;
-                        solved = false;
-                        solveTime = 0.0f;
-                        solveTimeout = false;  // 重置超时标志
-                        solveCheckCount = 0;  // 重置求解调用计数器
-                        estimatedSolveTime = estimateSolveTime(pieceCounts);  // 预估求解时间
+                    } else {
+                        // 开始自动求解（允许多次求解；正在求解时点击则取消当前求解并重新开始）
                         solveTimer.restart();  // 开始计时
                         // 清空游戏板
                         for (int i = 0; i < BOARD_SIZE; i++) {
@@ -2491,32 +2754,7 @@ int main() {
                                 board[i][j] = 0;
                             }
                         }
-                        // 等待之前的线程结束（如果存在）
-                        if (solveThread && solveThread->joinable()) {
-                            solveThread->join();
-                            delete solveThread;
-                            solveThread = nullptr;
-                        }
-                        solveThread = new thread([&]() {
-            lock_guard<mutex> lock(boardMutex);
-                            // 创建pieceCounts的副本，确保求解使用的图块数量与求解开始时一致
-                            vector<PieceCount> countsCopy = pieceCounts;
-                            // 在120秒内求解
-                            if (solve(0, countsCopy)) {
-            solutionBoard = board;
-            solutionFound = true;
-            solved = true;
-        } else {
-                                solved = false;
-                                if (solveTimeout) {
-                                    // 超时了
-            solved = false;
-                                }
-        }
-        solving = false;
-                            solveTime = solveTimer.getElapsedTime().asSeconds();  // 记录求解时间
-                        });
-                        solveThread->detach();
+                        startSolveJob();
                     }
                 }
                 
@@ -2524,108 +2762,40 @@ int main() {
                 int testButton1X = buttonX + buttonWidth + 10;
                 if (mousePos.x >= testButton1X && mousePos.x < testButton1X + buttonWidth &&
                     mousePos.y >= buttonY && mousePos.y < buttonY + buttonHeight) {
-                    if (!solving) {
-                        // 设置测试用例1：4个cross和44个1x1
-                        setTestCase1();
-                        // 清空游戏板
-                        for (int i = 0; i < BOARD_SIZE; i++) {
-                            for (int j = 0; j < BOARD_SIZE; j++) {
-                                board[i][j] = 0;
-                            }
-                        }
-                        // 清除之前的求解结果
-                        solutionFound = false;
-                        solved = false;
-                        showSolution = false;
-                        
-                        // 开始自动求解（使用优化后的算法）
-                        solving = true;
-                        solveTime = 0.0f;
-                        solveTimeout = false;
-                        solveCheckCount = 0;
-                        estimatedSolveTime = estimateSolveTime(pieceCounts);  // 预估求解时间
-                        solveTimer.restart();
-                        // 等待之前的线程结束（如果存在）
-                        if (solveThread && solveThread->joinable()) {
-                            solveThread->join();
-                            delete solveThread;
-                            solveThread = nullptr;
+                    // 设置测试用例1：4个cross和44个1x1
+                    setTestCase1();
+                    // 清空游戏板
+                    for (int i = 0; i < BOARD_SIZE; i++) {
+                        for (int j = 0; j < BOARD_SIZE; j++) {
+                            board[i][j] = 0;
                         }
-                        solveThread = new thread([&]() {
-                            lock_guard<mutex> lock(boardMutex);
-                            // 创建pieceCounts的副本，确保求解使用的图块数量与求解开始时一致
-                            vector<PieceCount> countsCopy = pieceCounts;
-                            // 在120秒内求解（使用优化后的算法）
-                            if (solve(0, countsCopy)) {
-                                solutionBoard = board;
-                                solutionFound = true;
-                                solved = true;
-                            } else {
-                                solved = false;
-                                if (solveTimeout) {
-                                    // 超时了
-                                    solved = false;
-                                }
-                            }
-                            solving = false;
-                            solveTime = solveTimer.getElapsedTime().asSeconds();
-                        });
-                        solveThread->detach();
                     }
+                    // 清除之前的求解结果
+                    showSolution = false;
+                    
+                    // 开始自动求解（使用优化后的算法；正在进行的求解会被取消）
+                    solveTimer.restart();
+                    startSolveJob();
                 }
                 
                 // 处理测试用例2按钮点击
                 int testButton2X = testButton1X + buttonWidth + 10;
                 if (mousePos.x >= testButton2X && mousePos.x < testButton2X + buttonWidth &&
                     mousePos.y >= buttonY && mousePos.y < buttonY + buttonHeight) {
-                    if (!solving) {
-                        // 设置测试用例2：15个L-shape和4个1x1
-                        setTestCase2();
-                        // 清空游戏板
-                        for (int i = 0; i < BOARD_SIZE; i++) {
-                            for (int j = 0; j < BOARD_SIZE; j++) {
-                                board[i][j] = 0;
-                            }
+                    // 设置测试用例2：15个L-shape和4个1x1
+                    setTestCase2();
+                    // 清空游戏板
+                    for (int i = 0; i < BOARD_SIZE; i++) {
+                        for (int j = 0; j < BOARD_SIZE; j++) {
+                            board[i][j] = 0;
                         }
-                        // 清除之前的求解结果
-                        solutionFound = false;
-                        solved = false;
-                        showSolution = false;
-                        
-                        // 开始自动求解（使用优化后的算法）
-                        solving = true;
-                        solveTime = 0.0f;
-                        solveTimeout = false;
-                        solveCheckCount = 0;
-                        estimatedSolveTime = estimateSolveTime(pieceCounts);  // 预估求解时间
-                        solveTimer.restart();
-                        // 等待之前的线程结束（如果存在）
-                        if (solveThread && solveThread->joinable()) {
-                            solveThread->join();
-                            delete solveThread;
-                            solveThread = nullptr;
-                        }
-                        solveThread = new thread([&]() {
-                            lock_guard<mutex> lock(boardMutex);
-                            // 创建pieceCounts的副本，确保求解使用的图块数量与求解开始时一致
-                            vector<PieceCount> countsCopy = pieceCounts;
-                            // 在预估时间内求解（使用优化后的算法）
-                            if (solve(0, countsCopy)) {
-                                solutionBoard = board;
-                                solutionFound = true;
-                                solved = true;
-                            } else {
-                                solved = false;
-                                if (solveTimeout) {
-                                    // 超时了
-                                    solved = false;
-                                }
-                            }
-                            solving = false;
-                            solveTime = solveTimer.getElapsedTime().asSeconds();
-                        });
-                        solveThread->detach();
                     }
+                    // 清除之前的求解结果
+                    showSolution = false;
+                    
+                    // 开始自动求解（使用优化后的算法；正在进行的求解会被取消）
+                    solveTimer.restart();
+                    startSolveJob();
                 }
             }
             
@@ -3096,7 +3266,7 @@ int main() {
                                         
                                         // 如果不在原始位置范围内，且被其他图块占据，则不能放置
                                         // 注意：只检查形状中定义的单元格，边界框内的"透明"区域应该被视为空白
-                                        if (!isInOriginal && board[newRow][newCol] != 0) {
+                                        if (!isInOriginal && (board[newRow][newCol] != 0 || isBlockedCell(newRow, newCol))) {
                                             canPlaceHere = false;
                                             break;
                                         }
@@ -3150,6 +3320,8 @@ int main() {
         window.display();
     }
     
+    // 每次存入新结果后已经保存过，这里写入保存失败时遗留的修改
+    solutionCache.save();
     return 0;
 }
 
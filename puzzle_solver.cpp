@@ -0,0 +1,1073 @@
+#include "puzzle_solver.h"
+
+#include "board_search.h"
+#include "placement_filter.h"
+#include "standard_placements.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+namespace {
+
+// 本文件中的位棋盘（8x8，uint64_t）的几何，与BoardSolver<N>共用洪水填充和区域检查
+typedef Board<BOARD_SIZE> Geometry;
+static_assert(is_same<Geometry::Mask, BoardMask>::value, "8x8 geometry must use BoardMask");
+
+// 染色方式：第k种条纹中第j种颜色的格子（行、列、主对角线或副对角线编号模k等于j）
+enum StripeKind { STRIPE_ROW, STRIPE_COL, STRIPE_DIAGONAL, STRIPE_ANTI_DIAGONAL, STRIPE_KIND_COUNT };
+
+BoardMask stripeCells(int kind, int k, int j) {
+    BoardMask cells = 0;
+    for (int row = 0; row < BOARD_SIZE; row++) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            int line = row;
+            switch (kind) {
+                case STRIPE_COL: line = col; break;
+                case STRIPE_DIAGONAL: line = row + col; break;
+                case STRIPE_ANTI_DIAGONAL: line = row - col + BOARD_SIZE * k; break;
+                default: break;
+            }
+            if (line % k == j) cells |= cellBit(row, col);
+        }
+    }
+    return cells;
+}
+
+// SplitMix64伪随机数（用于生成固定的Zobrist键）
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+}  // namespace
+
+int PlacementTable::typeIndexOf(int pieceId) const {
+    for (size_t i = 0; i < pieces.size(); i++) {
+        if (pieces[i].id == pieceId) return (int)i;
+    }
+    return -1;
+}
+
+PlacementTable buildPlacementTable(BoardMask blocked) {
+    // 完整棋盘上的放置表在编译期生成，这里只去掉占用blocked中格子的放置并重新编号
+    typedef StandardPlacements<BOARD_SIZE> Standard;
+    const Standard::Table& full = Standard::table;
+    const int types = Standard::TYPES;
+
+    PlacementTable table;
+    table.pieces = standardPieces();
+    table.blocked = blocked;
+    table.cellCounts.assign(full.cellCounts, full.cellCounts + types);
+    table.placements.resize(types);
+    table.masks.resize(types);
+    table.orderByRegions.resize(types, false);
+    table.anchored.assign(BOARD_CELLS, vector<vector<int>>(types));
+    table.covering.assign(BOARD_CELLS, vector<vector<int>>(types));
+
+    // index[i] = 全局编号为i的放置在过滤后该图块列表中的位置（-1表示被挡住）
+    vector<int> index(Standard::COUNT, -1);
+    for (int t = 0; t < types; t++) {
+        table.orderByRegions[t] = (table.pieces[t].name == "cross");
+        auto& list = table.placements[t];
+        for (int i = full.typeStart[t]; i < full.typeStart[t + 1]; i++) {
+            if (full.masks[i] & blocked) continue;
+            index[i] = (int)list.size();
+            list.push_back({full.masks[i], full.shapeIndex[i], full.baseRow[i], full.baseCol[i]});
+            table.masks[t].push_back(full.masks[i]);
+        }
+    }
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        for (int k = full.anchoredStart[cell]; k < full.anchoredStart[cell + 1]; k++) {
+            int i = full.anchoredList[k];
+            if (index[i] >= 0) table.anchored[cell][full.type[i]].push_back(index[i]);
+        }
+        for (int k = full.coveringStart[cell]; k < full.coveringStart[cell + 1]; k++) {
+            int i = full.coveringList[k];
+            if (index[i] >= 0) table.covering[cell][full.type[i]].push_back(index[i]);
+        }
+    }
+    return table;
+}
+
+BoardMask transformMask(BoardMask mask, int g) {
+    const int last = BOARD_SIZE - 1;
+    BoardMask result = 0;
+    while (mask) {
+        int index = lowestBitIndex(mask);
+        mask &= mask - 1;
+        int row = index / BOARD_SIZE;
+        int col = index % BOARD_SIZE;
+        int r = row, c = col;
+        switch (g) {
+            case 1: r = col; c = last - row; break;          // 顺时针90度
+            case 2: r = last - row; c = last - col; break;   // 180度
+            case 3: r = last - col; c = row; break;          // 顺时针270度
+            case 4: c = last - col; break;                   // 左右翻转
+            case 5: r = last - row; break;                   // 上下翻转
+            case 6: r = col; c = row; break;                 // 主对角线翻转
+            case 7: r = last - col; c = last - row; break;   // 副对角线翻转
+            default: break;                                  // 恒等变换
+        }
+        result |= cellBit(r, c);
+    }
+    return result;
+}
+
+SymmetryInfo analyzeSymmetry(const PlacementTable& table, const vector<int>& remaining) {
+    SymmetryInfo info;
+    int typeCount = (int)table.pieces.size();
+
+    // 每种参与求解的图块的放置掩码集合（排序后便于比较）
+    vector<vector<BoardMask>> maskSets(typeCount);
+    for (int t = 0; t < typeCount; t++) {
+        if (remaining[t] <= 0) continue;
+        for (const auto& placement : table.placements[t]) {
+            maskSets[t].push_back(placement.mask);
+        }
+        sort(maskSets[t].begin(), maskSets[t].end());
+    }
+
+    // 找出保持实例不变的变换：每种图块的放置集合被映射为某种数量相同的图块的放置集合
+    // typeImage[g][t] = 变换g把图块t映射成的图块
+    vector<int> group;
+    vector<vector<int>> typeImage(D4_GROUP_SIZE, vector<int>(typeCount, -1));
+    for (int g = 0; g < D4_GROUP_SIZE; g++) {
+        // 被挡住的格子也必须映射到被挡住的格子上
+        bool invariant = transformMask(table.blocked, g) == table.blocked;
+        for (int t = 0; t < typeCount && invariant; t++) {
+            if (remaining[t] <= 0) continue;
+            vector<BoardMask> image;
+            for (BoardMask mask : maskSets[t]) {
+                image.push_back(transformMask(mask, g));
+            }
+            sort(image.begin(), image.end());
+            for (int u = 0; u < typeCount; u++) {
+                if (remaining[u] == remaining[t] && maskSets[u] == image) {
+                    typeImage[g][t] = u;
+                    break;
+                }
+            }
+            invariant = typeImage[g][t] >= 0;
+        }
+        if (invariant) group.push_back(g);
+    }
+    info.groupSize = (int)group.size();
+    if (info.groupSize <= 1) return info;
+
+    // 选择枢轴图块：只考虑数量为1的图块（有多个副本时，固定其中一个副本
+    // 并不能把解空间按轨道划分，子问题几乎和原问题一样大），
+    // 优先选稳定子群最大的（削减最多），再其次选格子数多的
+    int bestStabilizer = 1;
+    for (int t = 0; t < typeCount; t++) {
+        if (remaining[t] != 1) continue;
+        int stabilizer = 0;
+        for (int g : group) {
+            if (typeImage[g][t] == t) stabilizer++;
+        }
+        if (stabilizer < bestStabilizer) continue;
+        if (stabilizer == bestStabilizer &&
+            (info.pivotType < 0 || table.cellCounts[t] <= table.cellCounts[info.pivotType])) {
+            continue;
+        }
+        info.pivotType = t;
+        bestStabilizer = stabilizer;
+    }
+    if (info.pivotType < 0) return info;
+
+    // 在稳定子群（把枢轴图块映射为自身的变换）下划分枢轴图块的放置轨道，
+    // 每个轨道保留放置表中最靠前的一个作为代表
+    const auto& list = table.placements[info.pivotType];
+    vector<pair<BoardMask, int>> byMask;
+    for (size_t i = 0; i < list.size(); i++) {
+        byMask.push_back({list[i].mask, (int)i});
+    }
+    sort(byMask.begin(), byMask.end());
+
+    info.representative.assign(list.size(), false);
+    info.orbitSize.assign(list.size(), 0);
+    vector<bool> assigned(list.size(), false);
+    for (size_t i = 0; i < list.size(); i++) {
+        if (assigned[i]) continue;
+        info.representative[i] = true;
+        for (int g : group) {
+            if (typeImage[g][info.pivotType] != info.pivotType) continue;
+            BoardMask image = transformMask(list[i].mask, g);
+            auto it = lower_bound(byMask.begin(), byMask.end(), make_pair(image, -1));
+            if (it != byMask.end() && it->first == image && !assigned[it->second]) {
+                assigned[it->second] = true;
+                info.orbitSize[i]++;
+            }
+        }
+    }
+    return info;
+}
+
+ParityInfo analyzeParity(const PlacementTable& table, const vector<int>& remaining) {
+    // 尝试的染色：模2、3、4的行/列/对角线条纹（模2的对角线条纹就是国际象棋黑白格）
+    const int MAX_STRIPE_PERIOD = 4;
+    ParityInfo info;
+    int typeCount = (int)table.pieces.size();
+
+    for (int k = 2; k <= MAX_STRIPE_PERIOD; k++) {
+        for (int kind = 0; kind < STRIPE_KIND_COUNT; kind++) {
+            // 模2时两种颜色互补，覆盖一种颜色的格子数确定了另一种，只需检查一种
+            int colorCount = (k == 2) ? 1 : k;
+            for (int j = 0; j < colorCount; j++) {
+                ParityClass parityClass;
+                parityClass.cells = stripeCells(kind, k, j);
+                parityClass.coverable.assign(typeCount, 0);
+
+                // 每种图块都能覆盖0..格子数之间的任意个数时，该颜色不构成约束
+                bool constraining = false;
+                for (int t = 0; t < typeCount; t++) {
+                    if (remaining[t] <= 0) continue;
+                    uint32_t coverable = 0;
+                    for (const auto& placement : table.placements[t]) {
+                        coverable |= 1u << popCount(placement.mask & parityClass.cells);
+                    }
+                    parityClass.coverable[t] = coverable;
+                    if (coverable != (2u << table.cellCounts[t]) - 1) constraining = true;
+                }
+                if (!constraining) continue;
+
+                // 模2的主对角线与副对角线条纹是同一种染色，去掉重复
+                bool duplicate = false;
+                for (const auto& existing : info.classes) {
+                    if (existing.cells == parityClass.cells) duplicate = true;
+                }
+                if (!duplicate) info.classes.push_back(parityClass);
+            }
+        }
+    }
+    return info;
+}
+
+bool parityFeasible(const ParityInfo& parity, BoardMask occupied, const vector<int>& remaining) {
+    for (const auto& parityClass : parity.classes) {
+        // 位集子集和：第i位为1表示剩余图块可以正好覆盖i个该颜色的格子
+        // 每种颜色最多BOARD_CELLS / 2格，64位足够；超过空格数的部分不可能再减小，直接丢弃
+        int target = popCount(parityClass.cells & ~occupied);
+        BoardMask limit = (2ULL << target) - 1;
+        BoardMask reach = 1;
+        for (size_t t = 0; t < remaining.size() && reach; t++) {
+            uint32_t coverable = parityClass.coverable[t];
+            // 只能覆盖0格的图块不影响结果
+            if (remaining[t] <= 0 || coverable == 1) continue;
+            for (int copy = 0; copy < remaining[t]; copy++) {
+                BoardMask next = 0;
+                for (uint32_t bits = coverable; bits; bits &= bits - 1) {
+                    next |= reach << lowestBitIndex(bits);
+                }
+                next &= limit;
+                if (next == reach) break;
+                reach = next;
+            }
+        }
+        if (!((reach >> target) & 1)) return false;
+    }
+    return true;
+}
+
+int countSmallRegions(BoardMask occupied, int minSize) {
+    BoardMask empty = ~occupied;
+    int smallRegionCount = 0;
+    while (empty) {
+        BoardMask region = Geometry::floodFill(empty & (~empty + 1), empty);
+        if (popCount(region) < minSize) {
+            smallRegionCount++;
+        }
+        empty &= ~region;
+    }
+    return smallRegionCount;
+}
+
+bool regionsFeasible(const PlacementTable& table, BoardMask occupied, const vector<int>& remaining) {
+    return regionsFeasible<Geometry>(occupied, table.cellCounts, remaining);
+}
+
+void SearchLimits::start(double timeLimitSeconds) {
+    timeout = false;
+    cancelRequested = false;
+    stopped = false;
+    timeLimit = timeLimitSeconds;
+    startTime = chrono::steady_clock::now();
+}
+
+bool SearchLimits::poll() {
+    if (cancelFlag && cancelFlag->load(memory_order_relaxed)) {
+        cancelRequested = true;
+    } else if (timeLimit > 0.0 && elapsedSeconds() > timeLimit) {
+        timeout = true;
+    }
+    stopped = timeout || cancelRequested;
+    return stopped;
+}
+
+double SearchLimits::elapsedSeconds() const {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+void SolverArena::reserve(const PlacementTable& table) {
+    typeCount = (int)table.pieces.size();
+    maxPlacements = 0;
+    for (const auto& list : table.placements) {
+        maxPlacements = max(maxPlacements, (int)list.size());
+    }
+    // 每次放置至少占用一格，所以递归深度不超过BOARD_CELLS + 1
+    orders.assign((size_t)(BOARD_CELLS + 1) * typeCount, 0);
+    scored.assign((size_t)(BOARD_CELLS + 1) * maxPlacements, {0, 0});
+    candidates.assign((size_t)(BOARD_CELLS + 1) * maxPlacements, 0);
+    donation.clear();
+    donation.reserve(BOARD_CELLS + 1);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    entries.clear();
+    indexMask = 0;
+    statistics = TranspositionStats();
+    if (megabytes == 0) return;
+
+    size_t budget = megabytes * 1024 * 1024 / sizeof(Entry);
+    size_t size = 1;
+    while (size * 2 <= budget) size *= 2;
+    // 空表项的占用掩码为0：棋盘全空的局面只出现在根节点，不会被查询
+    entries.assign(size, {0, 0, 0});
+    indexMask = size - 1;
+}
+
+void TranspositionTable::clear() {
+    fill(entries.begin(), entries.end(), Entry{0, 0, 0});
+    statistics = TranspositionStats();
+}
+
+void TranspositionTable::resetStats() {
+    statistics = TranspositionStats();
+}
+
+bool TranspositionTable::probe(uint64_t key, BoardMask occupied, long long& solutions) {
+    statistics.probes++;
+    const Entry& entry = entries[key & indexMask];
+    if (entry.key == key && entry.occupied == occupied) {
+        statistics.hits++;
+        solutions = entry.solutions;
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, BoardMask occupied, long long solutions) {
+    statistics.stores++;
+    entries[key & indexMask] = {key, occupied, solutions};
+}
+
+void ZobristKeys::build(const PlacementTable& table) {
+    uint64_t state = 0x5EED5EED5EED5EEDULL;
+    uint64_t cellKeys[BOARD_CELLS];
+    for (auto& key : cellKeys) {
+        key = splitMix64(state);
+    }
+
+    size_t typeCount = table.pieces.size();
+    placementKeys.assign(typeCount, vector<uint64_t>());
+    countKeys.assign(typeCount, vector<uint64_t>());
+    lastKeys.assign(typeCount, vector<uint64_t>());
+    for (size_t t = 0; t < typeCount; t++) {
+        for (const auto& placement : table.placements[t]) {
+            uint64_t key = 0;
+            for (BoardMask mask = placement.mask; mask; mask &= mask - 1) {
+                key ^= cellKeys[lowestBitIndex(mask)];
+            }
+            placementKeys[t].push_back(key);
+        }
+        // 每种图块最多BOARD_CELLS个（每个至少占一格）
+        for (int count = 0; count <= BOARD_CELLS; count++) {
+            countKeys[t].push_back(splitMix64(state));
+        }
+        for (size_t i = 0; i <= table.placements[t].size(); i++) {
+            lastKeys[t].push_back(splitMix64(state));
+        }
+    }
+}
+
+BitboardSolver::BitboardSolver(const PlacementTable& table, const SolverOptions& options)
+    : table(table), options(options), countingOptions(false), hash(0), occupied(0), nodes(0), splitter(nullptr),
+      splitDepth(0), donated(0), enumerating(false), solutionCallback(nullptr), solutionCount(0) {
+    arena.reserve(table);
+    zobrist.build(table);
+    transpositions.resize(options.transpositionMegabytes);
+    remaining.assign(table.pieces.size(), 0);
+    lastPlaced.assign(table.pieces.size(), -1);
+    choices.assign(BOARD_CELLS, {0, 0, -1});
+    optionCounts.assign(BOARD_CELLS, 0);
+    solutionBoard.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
+}
+
+bool BitboardSolver::solve(const vector<PieceCount>& counts, double timeLimitSeconds) {
+    return start(counts, timeLimitSeconds) && searchSubtree(SearchPath());
+}
+
+bool BitboardSolver::start(const vector<PieceCount>& counts, double timeLimitSeconds) {
+    fill(remaining.begin(), remaining.end(), 0);
+    fill(lastPlaced.begin(), lastPlaced.end(), -1);
+    stats.reset(table.pieces.size());
+    occupied = table.blocked;
+    nodes = 0;
+    donated = 0;
+    solutionCount = 0;
+    limits.start(timeLimitSeconds);
+
+    int requiredCells = 0;
+    for (const auto& pc : counts) {
+        if (pc.count <= 0) continue;
+        int type = table.typeIndexOf(pc.pieceId);
+        // 未知图块或无法放入棋盘的图块：不可能用满指定数量
+        if (type < 0 || table.placements[type].empty()) return false;
+        remaining[type] += pc.count;
+        requiredCells += pc.count * table.cellCounts[type];
+    }
+
+    // 每次放置都会同时减少剩余格子数和剩余图块面积，
+    // 所以只有总面积正好等于棋盘（除去被挡住的格子）的面积时才可能填满
+    if (requiredCells != table.openCells()) {
+        SOLVER_STATS(stats.prunes[PRUNE_AREA]++);
+        return false;
+    }
+
+    // 染色奇偶性不满足的组合（如T-shape数量为奇数而其余图块都黑白各半）不用搜索就能判定无解
+    parity = analyzeParity(table, remaining);
+    if (!parityFeasible(parity, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_PARITY]++);
+        return false;
+    }
+
+    // 局面是否无解只取决于局面本身（与初始的图块组合无关），表项在多次solve()之间继续有效
+    transpositions.resetStats();
+    hash = 0;
+    for (int t = 0; t < arena.typeCount; t++) {
+        hash ^= typeKey(t);
+    }
+
+    countingOptions = options.branching == BRANCH_MOST_CONSTRAINED;
+    if (countingOptions) {
+        buildOptionCounts();
+    }
+
+    // 逐个传出解时需要每个解本身，不能只搜索轨道代表
+    bool useSymmetry = options.breakSymmetry && !(enumerating && solutionCallback);
+    symmetry = useSymmetry ? analyzeSymmetry(table, remaining) : SymmetryInfo();
+    return true;
+}
+
+long long BitboardSolver::enumerate(const vector<PieceCount>& counts, double timeLimitSeconds,
+                                    const SolutionCallback& onSolution) {
+    enumerating = true;
+    solutionCallback = onSolution ? &onSolution : nullptr;
+    bool orderCopies = options.orderCopies;
+    if (options.branching == BRANCH_PIECE_ORDER) {
+        options.orderCopies = true;
+    }
+
+    if (start(counts, timeLimitSeconds)) {
+        searchSubtree(SearchPath());
+    }
+
+    options.orderCopies = orderCopies;
+    enumerating = false;
+    solutionCallback = nullptr;
+    return solutionCount;
+}
+
+double TreeEstimate::firstSolutionNodes() const {
+    if (exact) return nodes;
+    return max(calibrationNodes, nodes / (solutions + 1.0));
+}
+
+double TreeEstimate::firstSolutionSeconds() const {
+    return nodesPerSecond > 0.0 ? firstSolutionNodes() / nodesPerSecond : 0.0;
+}
+
+TreeEstimate BitboardSolver::estimateTree(const vector<PieceCount>& counts, int probes,
+                                          double calibrationSeconds, uint64_t seed) {
+    TreeEstimate estimate;
+    if (!start(counts, calibrationSeconds)) {
+        estimate.feasible = false;
+        estimate.exact = true;
+        return estimate;
+    }
+
+    // 校准：实际搜索一小段时间测量速度，简单的组合在这段时间内就能搜索完
+    bool found = searchSubtree(SearchPath());
+    estimate.nodesPerSecond = stats.nodesPerSecond();
+    estimate.calibrationNodes = (double)nodes;
+    if (!limits.stopped) {
+        estimate.exact = true;
+        estimate.solved = found;
+        estimate.nodes = (double)nodes;
+        estimate.solutions = found ? 1.0 : 0.0;
+        return estimate;
+    }
+    if (limits.cancelRequested || !start(counts, 0.0)) return estimate;
+
+    uint64_t state = seed;
+    vector<pair<int, int>> children;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    double solutionSum = 0.0;
+    int completed = 0;
+    for (; completed < probes; completed++) {
+        // 探测不经过search函数中的定期检查，每次探测前检查取消标志
+        if (limits.cancelFlag && limits.cancelFlag->load(memory_order_relaxed)) {
+            limits.cancelRequested = true;
+            break;
+        }
+        double weight = 1.0;
+        double probeNodes = 0.0;
+        int depth = 0;
+        bool descend = true;
+
+        // 对称性破除时根节点只展开枢轴图块的代表位置（根节点本身不计入节点数）
+        if (symmetry.pivotType >= 0) {
+            children.clear();
+            for (size_t i = 0; i < symmetry.representative.size(); i++) {
+                if (symmetry.representative[i]) children.push_back({symmetry.pivotType, (int)i});
+            }
+            descend = !children.empty();
+            if (descend) {
+                weight = (double)children.size();
+                const auto& child = children[splitMix64(state) % children.size()];
+                place(depth++, child.first, child.second);
+            }
+        }
+
+        // 与各个search函数一样：进入节点即计数，再判断解和剪枝
+        while (descend) {
+            probeNodes += weight;
+            if (occupied == FULL_BOARD_MASK) {
+                solutionSum += weight;
+                break;
+            }
+            if (options.pruneRegions && !regionsFeasible(table, occupied, remaining)) break;
+            if (options.checkParity && !parityFeasible(parity, occupied, remaining)) break;
+            collectChildren(depth, children);
+            if (children.empty()) break;
+            weight *= (double)children.size();
+            const auto& child = children[splitMix64(state) % children.size()];
+            place(depth++, child.first, child.second);
+        }
+        while (depth > 0) {
+            unplace(--depth);
+        }
+
+        sum += probeNodes;
+        sumSquares += probeNodes * probeNodes;
+    }
+
+    if (completed > 0) {
+        double mean = sum / completed;
+        double variance = max(0.0, sumSquares / completed - mean * mean);
+        estimate.nodes = mean;
+        estimate.solutions = solutionSum / completed;
+        estimate.relativeError = mean > 0.0 ? sqrt(variance / completed) / mean : 0.0;
+        estimate.probes = completed;
+    }
+    return estimate;
+}
+
+void BitboardSolver::collectChildren(int depth, vector<pair<int, int>>& children) {
+    // 与搜索时展开的子节点相同（不考虑置换表），顺序无关紧要
+    children.clear();
+    int orderSize = buildTypeOrder(depth);
+    const int* order = arena.orderAt(depth);
+    if (options.branching == BRANCH_FIRST_EMPTY) {
+        int cell = lowestBitIndex(~occupied);
+        for (int k = 0; k < orderSize; k++) {
+            int type = order[k];
+            for (int index : table.anchored[cell][type]) {
+                if (!(table.placements[type][index].mask & occupied)) children.push_back({type, index});
+            }
+        }
+        return;
+    }
+    if (options.branching == BRANCH_MOST_CONSTRAINED) {
+        int optionCount = 0;
+        int cell = mostConstrainedCell(optionCount);
+        if (optionCount == 0) return;
+        for (int k = 0; k < orderSize; k++) {
+            int type = order[k];
+            for (int index : table.covering[cell][type]) {
+                if (!(table.placements[type][index].mask & occupied)) children.push_back({type, index});
+            }
+        }
+        return;
+    }
+    int* candidates = arena.candidatesAt(depth);
+    for (int k = 0; k < orderSize; k++) {
+        int type = order[k];
+        int firstIndex = options.orderCopies ? lastPlaced[type] + 1 : 0;
+        int candidateCount = filterFreePlacements(table.masks[type].data() + firstIndex,
+                                                  (int)table.masks[type].size() - firstIndex, occupied, candidates);
+        for (int c = 0; c < candidateCount; c++) {
+            children.push_back({type, firstIndex + candidates[c]});
+        }
+        if (options.orderCopies) break;
+    }
+}
+
+bool BitboardSolver::searchSubtree(const SearchPath& path) {
+    bool found = false;
+    if (path.empty()) {
+        found = searchRoot();
+    } else {
+        // 重放路径上的放置，再从路径末端继续搜索
+        int depth = 0;
+        for (const auto& step : path) {
+            place(depth++, step.first, step.second);
+        }
+        found = searchFrom(depth);
+        while (depth > 0) {
+            unplace(--depth);
+        }
+    }
+
+    // 节点数和耗时不依赖PUZZLE_SOLVER_STATS，总是可用
+    stats.nodes = nodes;
+    stats.seconds = limits.elapsedSeconds();
+    return found;
+}
+
+void BitboardSolver::setSplitter(SubtreeSplitter* subtreeSplitter, int maxDepth) {
+    splitter = subtreeSplitter;
+    splitDepth = maxDepth;
+}
+
+bool BitboardSolver::offerSubtree(int depth, int type, int index) {
+    if (!splitter || depth >= splitDepth || !splitter->hungry()) return false;
+    // 路径写入预留好容量的arena.donation，不在搜索中分配
+    SearchPath& path = arena.donation;
+    path.clear();
+    for (int d = 0; d < depth; d++) {
+        path.push_back({choices[d].type, choices[d].placementIndex});
+    }
+    path.push_back({type, index});
+    splitter->donate(path);
+    donated++;
+    return true;
+}
+
+bool BitboardSolver::searchRoot() {
+    if (symmetry.pivotType < 0) return searchFrom(0);
+
+    // 对称性破除：任意解都可以经对称变换使枢轴图块落在轨道代表位置上，
+    // 所以根节点只需把枢轴图块依次放在各个代表位置，再从第1层开始正常搜索
+    int type = symmetry.pivotType;
+    const auto& list = table.placements[type];
+    for (size_t i = 0; i < list.size(); i++) {
+        if (!symmetry.representative[i]) continue;
+        if (offerSubtree(0, type, (int)i)) continue;
+        long long solutionsBefore = solutionCount;
+        place(0, type, (int)i);
+        bool found = searchFrom(1);
+        unplace(0);
+        // 轨道中其他位置上的解是代表位置上的解的对称像，一一对应
+        solutionCount += (solutionCount - solutionsBefore) * (symmetry.orbitSize[i] - 1);
+        if (found) return true;
+        if (limits.stopped) return false;
+    }
+    return false;
+}
+
+bool BitboardSolver::searchFrom(int depth) {
+    switch (options.branching) {
+        case BRANCH_FIRST_EMPTY: return searchFirstEmpty(depth);
+        case BRANCH_MOST_CONSTRAINED: return searchMostConstrained(depth);
+        default: return search(depth);
+    }
+}
+
+bool BitboardSolver::search(int depth) {
+    nodes++;
+    SOLVER_STATS(stats.maxDepth = max(stats.maxDepth, depth));
+    if (limits.check(nodes)) {
+        SOLVER_STATS(stats.prunes[PRUNE_TIMEOUT]++);
+        return false;
+    }
+
+    // 面积在根节点已经校验过，棋盘填满即意味着所有图块都正好用完
+    if (occupied == FULL_BOARD_MASK) {
+        if (enumerating) return acceptSolution(depth);
+        buildSolution(depth);
+        return true;
+    }
+    if (options.pruneRegions && !regionsFeasible(table, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_REGION]++);
+        return false;
+    }
+    if (options.checkParity && !parityFeasible(parity, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_PARITY]++);
+        return false;
+    }
+    if (settledByTable()) {
+        SOLVER_STATS(stats.prunes[PRUNE_TRANSPOSITION]++);
+        return false;
+    }
+    long long donatedBefore = donated;
+    long long solutionsBefore = solutionCount;
+
+    int orderSize = buildTypeOrder(depth);
+    if (orderSize == 0) return false;
+    const int* order = arena.orderAt(depth);
+
+    int* candidates = arena.candidatesAt(depth);
+    for (int k = 0; k < orderSize; k++) {
+        int type = order[k];
+        const auto& list = table.placements[type];
+
+        auto tryPlacement = [&](int index) {
+            if (offerSubtree(depth, type, index)) return false;
+            place(depth, type, index);
+            if (search(depth + 1)) return true;
+            unplace(depth);
+            return false;
+        };
+
+        // 同种图块的副本互相等价：只允许按放置索引递增的顺序放置，
+        // 同一组位置只会以一种顺序被尝试（避免count!种排列）
+        int firstIndex = options.orderCopies ? lastPlaced[type] + 1 : 0;
+
+        // 一次过滤出所有不与已占用格子重叠的放置（candidates中为相对firstIndex的索引）；
+        // 这一层的occupied在各个分支返回后不变，所以先过滤再逐个尝试与逐个测试的结果相同
+        int testCount = (int)list.size() - firstIndex;
+        int candidateCount = filterFreePlacements(table.masks[type].data() + firstIndex, testCount, occupied,
+                                                  candidates);
+        SOLVER_STATS(stats.placementTests += testCount);
+
+        if (table.orderByRegions[type]) {
+            // Cross特殊优化：优先尝试靠近中心且不会产生孤立小区域的位置
+            pair<int, int>* positions = arena.scoredAt(depth);  // {score, placementIndex}
+            int positionCount = 0;
+            for (int c = 0; c < candidateCount; c++) {
+                int i = firstIndex + candidates[c];
+                int distFromCenter = abs(list[i].baseRow - BOARD_SIZE / 2) +
+                                     abs(list[i].baseCol - BOARD_SIZE / 2);
+                int smallRegions = countSmallRegions(occupied | list[i].mask, 5);
+                positions[positionCount++] = {distFromCenter * 10 + smallRegions * 1000, i};
+            }
+            sort(positions, positions + positionCount);
+            for (int p = 0; p < positionCount; p++) {
+                if (tryPlacement(positions[p].second)) return true;
+                if (limits.stopped) return false;
+            }
+        } else {
+            for (int c = 0; c < candidateCount; c++) {
+                if (tryPlacement(firstIndex + candidates[c])) return true;
+                if (limits.stopped) return false;
+            }
+        }
+
+        // 副本按规范顺序放置时，排在最前的图块的下一个副本总要放在某个索引更大的位置上，
+        // 只在它上面分支已经完整；再尝试其他图块只会以另一种交错顺序重复同样的局面
+        if (options.orderCopies) break;
+    }
+
+    recordResult(donatedBefore, solutionsBefore);
+    return false;
+}
+
+bool BitboardSolver::searchFirstEmpty(int depth) {
+    nodes++;
+    SOLVER_STATS(stats.maxDepth = max(stats.maxDepth, depth));
+    if (limits.check(nodes)) {
+        SOLVER_STATS(stats.prunes[PRUNE_TIMEOUT]++);
+        return false;
+    }
+
+    if (occupied == FULL_BOARD_MASK) {
+        if (enumerating) return acceptSolution(depth);
+        buildSolution(depth);
+        return true;
+    }
+    if (options.pruneRegions && !regionsFeasible(table, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_REGION]++);
+        return false;
+    }
+    if (options.checkParity && !parityFeasible(parity, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_PARITY]++);
+        return false;
+    }
+    if (settledByTable()) {
+        SOLVER_STATS(stats.prunes[PRUNE_TRANSPOSITION]++);
+        return false;
+    }
+    long long donatedBefore = donated;
+    long long solutionsBefore = solutionCount;
+
+    // 最低的空格必须被覆盖，且覆盖它的放置不能占用更低的格子（都已被占用）
+    int cell = lowestBitIndex(~occupied);
+    int orderSize = buildTypeOrder(depth);
+    const int* order = arena.orderAt(depth);
+
+    for (int k = 0; k < orderSize; k++) {
+        int type = order[k];
+        const auto& list = table.placements[type];
+        for (int index : table.anchored[cell][type]) {
+            SOLVER_STATS(stats.placementTests++);
+            if (list[index].mask & occupied) continue;
+            if (offerSubtree(depth, type, index)) continue;
+            place(depth, type, index);
+            if (searchFirstEmpty(depth + 1)) return true;
+            unplace(depth);
+            if (limits.stopped) return false;
+        }
+    }
+
+    recordResult(donatedBefore, solutionsBefore);
+    return false;
+}
+
+bool BitboardSolver::searchMostConstrained(int depth) {
+    nodes++;
+    SOLVER_STATS(stats.maxDepth = max(stats.maxDepth, depth));
+    if (limits.check(nodes)) {
+        SOLVER_STATS(stats.prunes[PRUNE_TIMEOUT]++);
+        return false;
+    }
+
+    if (occupied == FULL_BOARD_MASK) {
+        if (enumerating) return acceptSolution(depth);
+        buildSolution(depth);
+        return true;
+    }
+
+    // 先于区域和奇偶性检查：某格没有候选时不必再做洪水填充
+    int optionCount = 0;
+    int cell = mostConstrainedCell(optionCount);
+    if (optionCount == 0) {
+        SOLVER_STATS(stats.prunes[PRUNE_DEAD_CELL]++);
+        return false;
+    }
+    if (options.pruneRegions && !regionsFeasible(table, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_REGION]++);
+        return false;
+    }
+    if (options.checkParity && !parityFeasible(parity, occupied, remaining)) {
+        SOLVER_STATS(stats.prunes[PRUNE_PARITY]++);
+        return false;
+    }
+    if (settledByTable()) {
+        SOLVER_STATS(stats.prunes[PRUNE_TRANSPOSITION]++);
+        return false;
+    }
+    long long donatedBefore = donated;
+    long long solutionsBefore = solutionCount;
+
+    // 只有一个候选的格子只能用这个放置覆盖：连续放下被迫的放置，直到没有这样的格子，再在候选最少的格子上分支
+    // 被迫的放置占用choices中随后的层（交出子树和重放路径时与分支的层一样），返回前按相反顺序撤销；
+    // 它们不改变局面的结论，所以置换表仍按进入本节点时的局面查询和记录
+    int branchDepth = depth;
+    int forcedType = 0;
+    int forcedIndex = 0;
+    while (optionCount == 1 && onlyOption(cell, forcedType, forcedIndex)) {
+        SOLVER_STATS(stats.forcedPlacements++);
+        place(branchDepth++, forcedType, forcedIndex);
+        if (occupied == FULL_BOARD_MASK) break;
+        cell = mostConstrainedCell(optionCount);
+    }
+
+    if (occupied == FULL_BOARD_MASK) {
+        if (!enumerating) {
+            buildSolution(branchDepth);
+            return true;
+        }
+        if (acceptSolution(branchDepth)) return true;
+    } else if (optionCount == 0) {
+        SOLVER_STATS(stats.prunes[PRUNE_DEAD_CELL]++);
+    } else {
+        // 每个解中正好有一个放置覆盖该格，所以各分支的解互不重复
+        int orderSize = buildTypeOrder(branchDepth);
+        const int* order = arena.orderAt(branchDepth);
+        for (int k = 0; k < orderSize && !limits.stopped; k++) {
+            int type = order[k];
+            const auto& list = table.placements[type];
+            for (int index : table.covering[cell][type]) {
+                SOLVER_STATS(stats.placementTests++);
+                if (list[index].mask & occupied) continue;
+                if (offerSubtree(branchDepth, type, index)) continue;
+                place(branchDepth, type, index);
+                if (searchMostConstrained(branchDepth + 1)) return true;
+                unplace(branchDepth);
+                if (limits.stopped) break;
+            }
+        }
+    }
+
+    while (branchDepth > depth) {
+        unplace(--branchDepth);
+    }
+    recordResult(donatedBefore, solutionsBefore);
+    return false;
+}
+
+int BitboardSolver::mostConstrainedCell(int& optionCount) const {
+    // 各格的候选数由place()/unplace()增量维护，这里只比较空格的计数；
+    // 找到没有候选或只有一个候选的格子时不用再看其他格子
+    int bestCell = -1;
+    optionCount = INT_MAX;
+    for (BoardMask empty = ~occupied; empty; empty &= empty - 1) {
+        int cell = lowestBitIndex(empty);
+        int count = optionCounts[cell];
+        if (count < optionCount) {
+            optionCount = count;
+            bestCell = cell;
+            if (count <= 1) break;
+        }
+    }
+    return bestCell;
+}
+
+bool BitboardSolver::onlyOption(int cell, int& type, int& index) const {
+    for (int t = 0; t < arena.typeCount; t++) {
+        if (remaining[t] <= 0) continue;
+        for (int i : table.covering[cell][t]) {
+            if (table.masks[t][i] & occupied) continue;
+            type = t;
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void BitboardSolver::buildOptionCounts() {
+    fill(optionCounts.begin(), optionCounts.end(), 0);
+    for (int t = 0; t < arena.typeCount; t++) {
+        if (remaining[t] <= 0) continue;
+        for (BoardMask mask : table.masks[t]) {
+            if (mask & occupied) continue;
+            for (BoardMask cells = mask; cells; cells &= cells - 1) {
+                optionCounts[lowestBitIndex(cells)]++;
+            }
+        }
+    }
+}
+
+void BitboardSolver::updateOptionCounts(int type, BoardMask mask, int delta) {
+    // 在放下type的放置mask之前（delta = -1）或撤销之后（delta = +1）调用，两次处理的是同一组放置：
+    // 原来可用、与mask重叠的放置（包括mask本身），每个只在它与mask重叠的最低格处理一次
+    int* counts = optionCounts.data();
+    auto adjust = [counts, delta](BoardMask other) {
+        for (BoardMask cells = other; cells; cells &= cells - 1) {
+            counts[lowestBitIndex(cells)] += delta;
+        }
+    };
+    for (BoardMask cells = mask; cells; cells &= cells - 1) {
+        int cell = lowestBitIndex(cells);
+        BoardMask blocking = occupied | (mask & (cellBit(cell / BOARD_SIZE, cell % BOARD_SIZE) - 1));
+        const auto& cover = table.covering[cell];
+        for (int t = 0; t < arena.typeCount; t++) {
+            if (remaining[t] <= 0) continue;
+            const BoardMask* masks = table.masks[t].data();
+            for (int index : cover[t]) {
+                BoardMask other = masks[index];
+                if (!(other & blocking)) adjust(other);
+            }
+        }
+    }
+    // 放下该图块的最后一个副本后，它其余不与mask重叠的放置也不再可用
+    if (remaining[type] == 1) {
+        BoardMask after = occupied | mask;
+        for (BoardMask other : table.masks[type]) {
+            if (!(other & after)) adjust(other);
+        }
+    }
+}
+
+void BitboardSolver::place(int depth, int type, int index) {
+    bool hashing = transpositions.enabled();
+    if (hashing) hash ^= typeKey(type);
+    if (countingOptions) updateOptionCounts(type, table.placements[type][index].mask, -1);
+    occupied ^= table.placements[type][index].mask;
+    remaining[type]--;
+    SOLVER_STATS(stats.placementsTried[type]++);
+    choices[depth] = {type, index, lastPlaced[type]};
+    lastPlaced[type] = index;
+    if (hashing) hash ^= typeKey(type) ^ zobrist.placementKeys[type][index];
+}
+
+void BitboardSolver::unplace(int depth) {
+    const Choice& choice = choices[depth];
+    bool hashing = transpositions.enabled();
+    if (hashing) hash ^= typeKey(choice.type) ^ zobrist.placementKeys[choice.type][choice.placementIndex];
+    lastPlaced[choice.type] = choice.previousLast;
+    remaining[choice.type]++;
+    occupied ^= table.placements[choice.type][choice.placementIndex].mask;
+    if (countingOptions) updateOptionCounts(choice.type, table.placements[choice.type][choice.placementIndex].mask, 1);
+    if (hashing) hash ^= typeKey(choice.type);
+}
+
+uint64_t BitboardSolver::typeKey(int type) const {
+    uint64_t key = zobrist.countKeys[type][remaining[type]];
+    // 按图块类型分支且副本按规范顺序放置时，子树只会把剩余副本放在lastPlaced之后的位置，
+    // 这样的失败只对同一个lastPlaced成立，局面还要区分它（用完的图块不再受影响）
+    bool ordered = options.orderCopies && options.branching == BRANCH_PIECE_ORDER;
+    if (ordered && remaining[type] > 0) {
+        key ^= zobrist.lastKeys[type][lastPlaced[type] + 1];
+    }
+    return key;
+}
+
+bool BitboardSolver::settledByTable() {
+    long long solutions = 0;
+    if (!transpositions.enabled() || !transpositions.probe(hash, occupied, solutions)) return false;
+    if (solutions == 0) return true;
+    // 只计数时直接累加已知的解数；找第一个解或逐个传出解时仍要实际搜索
+    if (enumerating && !solutionCallback) {
+        solutionCount += solutions;
+        return true;
+    }
+    return false;
+}
+
+void BitboardSolver::recordResult(long long donatedBefore, long long solutionsBefore) {
+    // 超时、被取消或交出过子树的节点没有在本线程搜索完，不能记录
+    if (transpositions.enabled() && !limits.stopped && donated == donatedBefore) {
+        transpositions.store(hash, occupied, solutionCount - solutionsBefore);
+    }
+}
+
+bool BitboardSolver::acceptSolution(int depth) {
+    solutionCount++;
+    if (!solutionCallback) return false;
+    buildSolution(depth);
+    // 回调要求停止时返回true，与找到第一个解时一样直接退出搜索
+    return !(*solutionCallback)(solutionBoard);
+}
+
+int BitboardSolver::buildTypeOrder(int depth) {
+    // 按大小降序、剩余数量升序排列待放置的图块类型（大的先放，剩余少的优先）
+    int* order = arena.orderAt(depth);
+    int orderSize = 0;
+    for (int t = 0; t < arena.typeCount; t++) {
+        if (remaining[t] > 0) order[orderSize++] = t;
+    }
+    sort(order, order + orderSize, [this](int a, int b) {
+        if (table.cellCounts[a] != table.cellCounts[b]) {
+            return table.cellCounts[a] > table.cellCounts[b];
+        }
+        return remaining[a] < remaining[b];
+    });
+    return orderSize;
+}
+
+void BitboardSolver::buildSolution(int depth) {
+    buildSolutionBoard<Geometry>(solutionBoard, depth, [this](int d) {
+        const Choice& choice = choices[d];
+        return make_pair(table.pieces[choice.type].id, table.placements[choice.type][choice.placementIndex].mask);
+    });
+}
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "solver_stats.h"
+
+// 8x8游戏板（求解器与GUI共用）
+const int BOARD_SIZE = 8;
+const int BOARD_CELLS = BOARD_SIZE * BOARD_SIZE;
+
+// 棋盘占用掩码：第 (row * BOARD_SIZE + col) 位表示单元格 (row, col)
+typedef uint64_t BoardMask;
+const BoardMask FULL_BOARD_MASK = ~0ULL;
+
+inline BoardMask cellBit(int row, int col) {
+    return 1ULL << (row * BOARD_SIZE + col);
+}
+
+inline int popCount(BoardMask mask) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(mask);
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+// 最低位1的索引（mask不能为0）
+inline int lowestBitIndex(BoardMask mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+// 图块数量编辑器相关
+struct PieceCount {
+    int pieceId;
+    int count;
+    int currentShapeIndex;
+};
+
+// 求解器使用的图块定义（不依赖SFML，由GUI中的Piece转换而来）
+struct SolverPiece {
+    std::string name;
+    std::vector<std::vector<std::pair<int, int>>> shapes;
+    int id;
+};
+
+// 一个合法放置：占用掩码 + 对应的形状和基准点
+struct Placement {
+    BoardMask mask;
+    int shapeIndex;
+    int baseRow;
+    int baseCol;
+};
+
+// 预计算的放置表：每种图块在棋盘上所有合法放置的掩码（已去除重复形状）
+// 放置测试为一次AND，放置/移除为一次XOR
+// 不规则棋盘（缺角、缺口、洞）用blocked表示被挡住的格子：占用它们的放置在建表时就已去掉，
+// 求解器开始时把blocked当作已占用，搜索中不再为这些格子付出任何代价
+struct PlacementTable {
+    std::vector<SolverPiece> pieces;
+    BoardMask blocked = 0;                             // 不属于棋盘的格子
+    std::vector<int> cellCounts;                       // 每种图块的格子数
+    std::vector<std::vector<Placement>> placements;    // placements[type] = 该图块的所有合法放置
+    std::vector<std::vector<BoardMask>> masks;         // masks[type][i] = placements[type][i].mask（连续存放，供候选过滤）
+    std::vector<bool> orderByRegions;                  // 是否对该图块使用孤立区域启发式排序（cross）
+    // anchored[cell][type] = 以cell为最低占用格的放置索引（格子按row * BOARD_SIZE + col编号）
+    // 按格子顺序填充时，最低空格只可能被以它为最低格的放置覆盖
+    std::vector<std::vector<std::vector<int>>> anchored;
+    // covering[cell][type] = 占用cell的放置索引（按最少候选格分支时统计每个空格的候选放置）
+    std::vector<std::vector<std::vector<int>>> covering;
+
+    int typeIndexOf(int pieceId) const;
+    // 需要被图块铺满的格子数
+    int openCells() const { return BOARD_CELLS - popCount(blocked); }
+};
+
+// 标准图块库（standardPieces()）在去掉blocked后的棋盘上的放置表
+PlacementTable buildPlacementTable(BoardMask blocked = 0);
+
+// 计算小于minSize格的孤立空区域数量（用于启发式排序）
+int countSmallRegions(BoardMask occupied, int minSize);
+
+// 棋盘的D4对称群：4个旋转 + 4个翻转
+const int D4_GROUP_SIZE = 8;
+
+// 对掩码应用第g个D4变换（g = 0为恒等变换）
+BoardMask transformMask(BoardMask mask, int g);
+
+// 对称性分析结果：保持实例（棋盘及其被挡住的格子 + 图块数量）不变的D4变换，
+// 以及用于根节点对称性破除的"枢轴"图块（数量为1的图块）
+// 枢轴图块的放置被划分为若干轨道，每个轨道只保留一个代表放置；
+// 解数 = 各代表放置下的解数 × 该代表的轨道大小
+struct SymmetryInfo {
+    int groupSize = 1;                 // 保持实例不变的变换数（1表示没有对称性）
+    int pivotType = -1;                // 被限制的图块类型，-1表示不做对称性破除
+    std::vector<bool> representative;  // 枢轴图块的每个放置是否为轨道代表
+    std::vector<int> orbitSize;        // 代表放置所在轨道的大小（非代表为0）
+};
+
+// remaining[type] = 每种图块的数量；变换可以把一种图块映射为数量相同的另一种（如L-shape与L-mirror）
+SymmetryInfo analyzeSymmetry(const PlacementTable& table, const std::vector<int>& remaining);
+
+// 染色奇偶性：把棋盘按某种方式染色（国际象棋黑白格、按行/列/对角线模k的条纹），
+// 同一图块的不同放置覆盖某种颜色的格子数只有少数几种取值（如T-shape在黑白格上只能是1或3），
+// 剩余图块覆盖该颜色的格子数之和必须正好等于该颜色的空格数
+struct ParityClass {
+    BoardMask cells;                  // 该颜色的所有格子
+    // coverable[type]的第i位为1表示该图块有放置正好覆盖i个该颜色的格子
+    std::vector<uint32_t> coverable;
+};
+
+struct ParityInfo {
+    std::vector<ParityClass> classes;  // 只保留对当前图块组合有约束的颜色
+};
+
+// 对remaining中的图块组合生成染色约束（去除重复和不起作用的颜色）
+ParityInfo analyzeParity(const PlacementTable& table, const std::vector<int>& remaining);
+
+// 检查剩余图块能否在每种颜色上正好覆盖所有空格（必要条件；返回false则一定无解）
+bool parityFeasible(const ParityInfo& parity, BoardMask occupied, const std::vector<int>& remaining);
+
+// 每个连通的空区域都必须由剩余图块中的一部分正好铺满：检查每个区域的面积是否为剩余图块大小的某个子集和
+// （必要条件；返回false则一定无解）
+bool regionsFeasible(const PlacementTable& table, BoardMask occupied, const std::vector<int>& remaining);
+
+// 分支方式
+enum BranchingMode {
+    BRANCH_PIECE_ORDER,      // 按图块类型分支，尝试该图块的所有位置（原solve()的方式）
+    BRANCH_FIRST_EMPTY,      // 总是覆盖最低的空格，只尝试以该格为最低格的放置
+    // 统计每个空格还能被多少个放置覆盖（图块有剩余且不与已占用格子重叠，计数随放置/撤销增量更新），
+    // 覆盖候选最少的空格：某格没有候选时立即回溯，只有一个候选时该放置是被迫的，
+    // 连续放下所有被迫的放置后再分支
+    BRANCH_MOST_CONSTRAINED
+};
+
+// 求解器选项
+struct SolverOptions {
+    BranchingMode branching = BRANCH_PIECE_ORDER;
+    bool breakSymmetry = false;  // 棋盘和图块组合对称时，根节点只把枢轴图块放在轨道代表位置上
+    // 按图块类型分支时，所有副本按规范顺序放置：同种图块的副本按放置索引递增，
+    // 每个节点只放排序后第一种图块（不尝试副本间的排列和不同图块间的交错顺序）
+    // 按最低空格分支时副本本来就只会以一种顺序出现
+    bool orderCopies = false;
+    // 每个节点对空区域做洪水填充，若某个区域的面积无法由剩余图块的大小凑出（子集和），立即回溯
+    bool pruneRegions = false;
+    // 每个节点检查染色奇偶性（根节点总会检查一次）
+    bool checkParity = false;
+    // 置换表大小（MB），记录已证明无解的局面（计数时还记录局面的解数），0表示不使用
+    size_t transpositionMegabytes = 0;
+};
+
+// 枚举解的回调：参数为解的棋盘（单元格为pieceId），返回false停止枚举
+typedef std::function<bool(const std::vector<std::vector<int>>&)> SolutionCallback;
+
+// 置换表统计
+struct TranspositionStats {
+    long long probes = 0;  // 查询次数
+    long long hits = 0;    // 命中（局面已知无解或解数已知，直接剪枝）
+    long long stores = 0;  // 写入次数
+
+    long long misses() const { return probes - hits; }
+    double hitRate() const { return probes > 0 ? (double)hits / probes : 0.0; }
+};
+
+// 局面的置换表：固定大小、直接映射，冲突时新项覆盖旧项
+// 同一局面（占用格子 + 剩余图块）常经不同的放置顺序重复到达，命中即可剪掉整棵已知无解的子树；
+// 计数时记录局面的解数，命中时直接累加
+// 每项保存完整的64位键和占用掩码：只有占用掩码相同、剩余数量（或规范顺序的lastPlaced）不同、
+// 而64位Zobrist键又恰好相同的两个局面才会被误认为同一局面，这两项没有单独校验；
+// 对任意两个这样的局面，概率约为2^-64（表的大小只决定哪些项被覆盖，不影响这个概率）
+class TranspositionTable {
+public:
+    // 按内存预算分配（向下取2的幂个表项），megabytes = 0时禁用
+    void resize(size_t megabytes);
+    void clear();
+    void resetStats();
+    bool enabled() const { return !entries.empty(); }
+    // 查到局面时返回true，solutions为该局面之后的解数（0表示无解）
+    bool probe(uint64_t key, BoardMask occupied, long long& solutions);
+    void store(uint64_t key, BoardMask occupied, long long solutions);
+    const TranspositionStats& stats() const { return statistics; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        BoardMask occupied;
+        long long solutions;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t indexMask = 0;
+    TranspositionStats statistics;
+};
+
+// Zobrist哈希键（固定种子生成，结果可复现）
+// 局面哈希 = 各放置所占格子的键 ^ 每种图块剩余数量的键 ^（副本按规范顺序放置时）每种图块最近放置位置的键
+struct ZobristKeys {
+    std::vector<std::vector<uint64_t>> placementKeys;  // [type][placement] = 所占格子的键的异或
+    std::vector<std::vector<uint64_t>> countKeys;      // [type][count]
+    std::vector<std::vector<uint64_t>> lastKeys;       // [type][lastPlaced + 1]
+
+    void build(const PlacementTable& table);
+};
+
+// 从根节点开始的一串放置{type, placementIndex}，唯一确定搜索树中的一个子树
+typedef std::vector<std::pair<int, int>> SearchPath;
+
+// 求解器的预分配工作区：每一层递归使用的临时数组在构造时一次性分配，
+// 搜索过程中不再进行任何堆分配（solver_allocation_test检查）
+struct SolverArena {
+    int typeCount;
+    int maxPlacements;                        // 单个图块类型的最大放置数
+    std::vector<int> orders;                  // 每层的图块类型顺序，typeCount个一组
+    std::vector<std::pair<int, int>> scored;  // 每层的{score, placementIndex}，maxPlacements个一组
+    std::vector<int> candidates;              // 每层过滤出的不重叠放置索引，maxPlacements个一组
+    SearchPath donation;                      // 交给splitter的子树路径，容量预留到最大深度
+
+    void reserve(const PlacementTable& table);
+    int* orderAt(int depth) { return &orders[depth * typeCount]; }
+    std::pair<int, int>* scoredAt(int depth) { return &scored[depth * maxPlacements]; }
+    int* candidatesAt(int depth) { return &candidates[depth * maxPlacements]; }
+};
+
+// 搜索的停止条件：时间限制和外部取消标志（BitboardSolver、ExactCoverSolver和BoardSolver<N>共用）
+// 每1024个节点才读一次时钟和取消标志；一旦超时或被取消，stopped保持为true直到下一次start()
+struct SearchLimits {
+    const std::atomic<bool>* cancelFlag = nullptr;
+    bool timeout = false;
+    bool cancelRequested = false;
+    bool stopped = false;  // 超时或被取消，搜索正在退出
+    double timeLimit = 0.0;  // <= 0 表示不限时
+    std::chrono::steady_clock::time_point startTime;
+
+    void start(double timeLimitSeconds);
+    // 在每个节点计数之后调用，返回stopped
+    bool check(long long nodes) {
+        if (stopped) return true;
+        if ((nodes & 1023) != 0) return false;
+        return poll();
+    }
+    bool poll();
+    double elapsedSeconds() const;
+};
+
+// 并行搜索的任务分发接口：搜索中途可以把还没探索的子树交给其他线程
+class SubtreeSplitter {
+public:
+    virtual ~SubtreeSplitter() {}
+    // 是否有线程在等待任务（在浅层的每个分支前调用，需要足够快）
+    virtual bool hungry() const = 0;
+    // 接收一个子树，本线程随后跳过它；path只在调用期间有效，需要保存时由实现复制
+    // （复制在splitter中进行，只发生在有线程等待时，不属于搜索本身的零分配保证）
+    virtual void donate(const SearchPath& path) = 0;
+};
+
+// 搜索树大小的估计（BitboardSolver::estimateTree()）
+struct TreeEstimate {
+    bool feasible = true;         // false表示面积或染色奇偶性在根节点就不满足，不需要搜索
+    bool exact = false;           // 校准搜索已经完成，nodes为实际节点数
+    bool solved = false;          // exact时是否找到了解（此时nodes为找到第一个解用的节点数）
+    double nodes = 0.0;           // 穷举整棵搜索树的预计节点数（不计置换表的剪枝，偏保守）
+    double solutions = 0.0;       // 预计的解数（对称性破除时只计轨道代表上的解）
+    double relativeError = 0.0;   // nodes的相对标准误差（由各次探测的方差得到）
+    double nodesPerSecond = 0.0;  // 校准搜索测得的速度
+    double calibrationNodes = 0.0;  // 校准搜索用掉的节点数（没有找到解，所以找第一个解至少要这么多）
+    int probes = 0;
+
+    // 找到第一个解预计需要的节点数：假设解在树中均匀分布，约为 nodes / (solutions + 1)
+    // 解很稀少时探测通常一个解也碰不到，结果接近nodes，应视为上界
+    double firstSolutionNodes() const;
+    double exhaustSeconds() const { return nodesPerSecond > 0.0 ? nodes / nodesPerSecond : 0.0; }
+    double firstSolutionSeconds() const;
+};
+
+// 位棋盘求解器：棋盘以uint64_t保存，所有放置测试都查预计算的放置表
+// 默认与原solve()相同的搜索顺序（大图块优先、剩余数量少的优先），
+// 也可以按最低空格分支（BRANCH_FIRST_EMPTY），避免同一局面以不同顺序重复出现，
+// 或按候选放置最少的空格分支（BRANCH_MOST_CONSTRAINED）
+class BitboardSolver {
+public:
+    explicit BitboardSolver(const PlacementTable& table, const SolverOptions& options = SolverOptions());
+
+    // counts按pieceId匹配放置表中的图块类型；timeLimitSeconds <= 0 表示不限时
+    bool solve(const std::vector<PieceCount>& counts, double timeLimitSeconds);
+
+    // 分步求解（并行搜索用）：start()设置图块组合并开始计时，返回false表示不用搜索就能判定无解；
+    // 之后每次searchSubtree()搜索以path为前缀的子树（path为空时搜索整棵树）
+    bool start(const std::vector<PieceCount>& counts, double timeLimitSeconds);
+    bool searchSubtree(const SearchPath& path);
+
+    // 枚举所有解并返回解数（超时时为已找到的解数）
+    // onSolution非空时逐个传出解的棋盘（此时不做对称性破除，每个解都要实际搜到）；
+    // 为空时只计数，不生成棋盘，对称的解按轨道大小加权，置换表中的解数也可以直接累加
+    // 按图块类型分支时总是按规范顺序放置副本，保证每个解只对应一条搜索路径
+    long long enumerate(const std::vector<PieceCount>& counts, double timeLimitSeconds,
+                        const SolutionCallback& onSolution = SolutionCallback());
+
+    // 估计搜索树大小（Knuth的随机探测）：每次探测从根沿均匀随机的分支走到叶子，
+    // 路径上前k层分支数之积是第k层节点数的无偏估计，取probes次探测的平均值
+    // 先实际搜索calibrationSeconds秒测量搜索速度，在此时间内搜索完时直接返回实际值（exact）
+    // 每次探测前检查取消标志，被取消时只用已完成的探测（cancelled()为true）
+    TreeEstimate estimateTree(const std::vector<PieceCount>& counts, int probes = 2000,
+                              double calibrationSeconds = 0.1, uint64_t seed = 1);
+
+    // 深度小于maxDepth的分支可以交给splitter（nullptr表示不拆分）
+    void setSplitter(SubtreeSplitter* splitter, int maxDepth);
+    // cancel被置为true后搜索尽快停止（每1024个节点检查一次）
+    void setCancelFlag(const std::atomic<bool>* cancel) { limits.cancelFlag = cancel; }
+
+    bool timedOut() const { return limits.timeout; }
+    bool cancelled() const { return limits.cancelRequested; }
+    long long nodeCount() const { return nodes; }
+    const TranspositionStats& transpositionStats() const { return transpositions.stats(); }
+    // 节点数和耗时总是可用，其余计数器只在定义PUZZLE_SOLVER_STATS时统计
+    const SolverStats& statistics() const { return stats; }
+    // 解的棋盘（单元格为pieceId，0为空），仅在solve()返回true后有效
+    const std::vector<std::vector<int>>& solution() const { return solutionBoard; }
+
+private:
+    struct Choice {
+        int type;
+        int placementIndex;
+        int previousLast;  // 放置前该图块的lastPlaced，撤销时恢复
+    };
+
+    bool search(int depth);
+    bool searchFirstEmpty(int depth);
+    bool searchMostConstrained(int depth);
+    int mostConstrainedCell(int& optionCount) const;
+    bool onlyOption(int cell, int& type, int& index) const;
+    void buildOptionCounts();
+    void updateOptionCounts(int type, BoardMask mask, int delta);
+    int buildTypeOrder(int depth);
+    bool searchRoot();
+    bool searchFrom(int depth);
+    bool offerSubtree(int depth, int type, int index);
+    void place(int depth, int type, int index);
+    void unplace(int depth);
+    uint64_t typeKey(int type) const;
+    bool settledByTable();
+    void recordResult(long long donatedBefore, long long solutionsBefore);
+    bool acceptSolution(int depth);
+    void buildSolution(int depth);
+    void collectChildren(int depth, std::vector<std::pair<int, int>>& children);
+
+    const PlacementTable& table;
+    SolverOptions options;
+    SolverArena arena;
+    std::vector<int> remaining;
+    std::vector<Choice> choices;  // choices[depth] = 该层选择的放置（最多BOARD_CELLS层）
+    std::vector<int> lastPlaced;  // 每种图块最近放置的副本的放置索引（-1表示还没有放置）
+    // 按最少候选格分支时：optionCounts[cell] = 覆盖cell、不与已占用格子重叠且图块还有剩余的放置数，
+    // start()时生成，之后由place()/unplace()通过table.covering增量更新（只对空格有意义）
+    bool countingOptions;
+    std::vector<int> optionCounts;
+    SymmetryInfo symmetry;
+    ParityInfo parity;
+    ZobristKeys zobrist;
+    TranspositionTable transpositions;
+    uint64_t hash;  // 当前局面的Zobrist哈希，随放置/撤销增量更新
+    BoardMask occupied;
+    long long nodes;
+    SearchLimits limits;
+    std::vector<std::vector<int>> solutionBoard;
+    SubtreeSplitter* splitter;
+    int splitDepth;
+    long long donated;      // 交给splitter的子树数（交出过子树的节点不能记为无解）
+    bool enumerating;       // enumerate()中：找到解后继续搜索
+    const SolutionCallback* solutionCallback;
+    long long solutionCount;
+    SolverStats stats;
+};
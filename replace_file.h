@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+
+// 用from整个替换to（to已存在时覆盖），替换是一步完成的：任何时刻to要么是旧文件，要么是新文件
+// POSIX的rename本身就是原子替换；Windows上rename不能覆盖已存在的文件，改用MoveFileEx(MOVEFILE_REPLACE_EXISTING)
+// 用于先写临时文件、再替换正式文件的保存方式（解的缓存、检查点）；失败时返回false，两个文件都保持原样
+bool replaceFile(const std::string& from, const std::string& to);
@@ -0,0 +1,294 @@
+#include "resumable_solver.h"
+
+#include "replace_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+const int CHECKPOINT_VERSION = 2;
+
+}  // namespace
+
+ResumableSolver::ResumableSolver(const PlacementTable& table)
+    : table(table), mode(RESUMABLE_FIRST_SOLUTION), occupied(0), nodes(0), solutions(0), cancelFlag(nullptr) {
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        typeOrder.push_back((int)t);
+    }
+    stable_sort(typeOrder.begin(), typeOrder.end(), [&table](int a, int b) {
+        return table.cellCounts[a] > table.cellCounts[b];
+    });
+    remaining.assign(table.pieces.size(), 0);
+    solutionBoard.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
+}
+
+void ResumableSolver::reset() {
+    fill(remaining.begin(), remaining.end(), 0);
+    occupied = table.blocked;
+    stack.clear();
+    nodes = 0;
+    solutions = 0;
+}
+
+bool ResumableSolver::start(const vector<PieceCount>& pieceCounts, ResumableMode searchMode) {
+    reset();
+    counts = pieceCounts;
+    mode = searchMode;
+
+    int requiredCells = 0;
+    for (const auto& pc : counts) {
+        if (pc.count <= 0) continue;
+        int type = table.typeIndexOf(pc.pieceId);
+        if (type < 0 || table.placements[type].empty()) return false;
+        remaining[type] += pc.count;
+        requiredCells += pc.count * table.cellCounts[type];
+    }
+    if (requiredCells != table.openCells()) return false;
+
+    parity = analyzeParity(table, remaining);
+    if (!parityFeasible(parity, occupied, remaining)) return false;
+
+    pushFrame();
+    return true;
+}
+
+SearchStatus ResumableSolver::run(double timeLimitSeconds, const string& checkpointPath,
+                                  double checkpointIntervalSeconds) {
+    auto startTime = chrono::steady_clock::now();
+    auto lastCheckpoint = startTime;
+
+    bool checkDue = false;
+    while (!stack.empty()) {
+        // 每1024个节点检查一次时间和取消标志；放在循环开头，上一个节点无论被剪枝、是叶子还是已压入子节点，
+        // 都已处理完，栈处于可以保存和恢复的状态（被跳过的continue不会推迟检查）
+        if (checkDue) {
+            checkDue = false;
+            auto now = chrono::steady_clock::now();
+            chrono::duration<double> elapsed = now - startTime;
+            bool cancelled = cancelFlag && cancelFlag->load(memory_order_relaxed);
+            if (cancelled || (timeLimitSeconds > 0.0 && elapsed.count() > timeLimitSeconds)) {
+                if (!checkpointPath.empty()) saveCheckpoint(checkpointPath);
+                return SEARCH_PAUSED;
+            }
+            chrono::duration<double> sinceCheckpoint = now - lastCheckpoint;
+            if (!checkpointPath.empty() && sinceCheckpoint.count() > checkpointIntervalSeconds) {
+                saveCheckpoint(checkpointPath);
+                lastCheckpoint = now;
+            }
+        }
+
+        Frame& frame = stack.back();
+        // 从子节点回溯或上一个放置被剪枝：先撤销，再尝试该层的下一个放置
+        if (frame.placed) {
+            unplaceFrame(frame);
+        }
+        if (!advance(frame)) {
+            stack.pop_back();
+            continue;
+        }
+        nodes++;
+        checkDue = (nodes & 1023) == 0;
+
+        if (occupied == FULL_BOARD_MASK) {
+            solutions++;
+            if (mode == RESUMABLE_FIRST_SOLUTION) {
+                buildSolution();
+                return SEARCH_FOUND;
+            }
+            continue;
+        }
+        if (!regionsFeasible(table, occupied, remaining)) continue;
+        if (!parityFeasible(parity, occupied, remaining)) continue;
+        pushFrame();
+    }
+
+    if (!checkpointPath.empty()) saveCheckpoint(checkpointPath);
+    return SEARCH_EXHAUSTED;
+}
+
+bool ResumableSolver::advance(Frame& frame) {
+    int candidate = frame.candidate + 1;
+    for (int slot = frame.typeSlot; slot < (int)typeOrder.size(); slot++, candidate = 0) {
+        int type = typeOrder[slot];
+        if (remaining[type] <= 0) continue;
+        const auto& list = table.anchored[frame.cell][type];
+        for (; candidate < (int)list.size(); candidate++) {
+            if (table.placements[type][list[candidate]].mask & occupied) continue;
+            frame.typeSlot = slot;
+            frame.candidate = candidate;
+            placeFrame(frame);
+            return true;
+        }
+    }
+    return false;
+}
+
+BoardMask ResumableSolver::frameMask(const Frame& frame) const {
+    int type = frameType(frame);
+    return table.placements[type][table.anchored[frame.cell][type][frame.candidate]].mask;
+}
+
+void ResumableSolver::placeFrame(Frame& frame) {
+    occupied ^= frameMask(frame);
+    remaining[frameType(frame)]--;
+    frame.placed = true;
+}
+
+void ResumableSolver::unplaceFrame(Frame& frame) {
+    occupied ^= frameMask(frame);
+    remaining[frameType(frame)]++;
+    frame.placed = false;
+}
+
+void ResumableSolver::pushFrame() {
+    stack.push_back({lowestBitIndex(~occupied), 0, -1, false});
+}
+
+void ResumableSolver::buildSolution() {
+    for (auto& row : solutionBoard) {
+        fill(row.begin(), row.end(), 0);
+    }
+    for (const auto& frame : stack) {
+        if (!frame.placed) continue;
+        int id = table.pieces[frameType(frame)].id;
+        for (BoardMask mask = frameMask(frame); mask; mask &= mask - 1) {
+            int index = lowestBitIndex(mask);
+            solutionBoard[index / BOARD_SIZE][index % BOARD_SIZE] = id;
+        }
+    }
+}
+
+bool ResumableSolver::saveCheckpoint(const string& path) const {
+    string tempPath = path + ".tmp";
+    {
+        ofstream file(tempPath);
+        if (!file.is_open()) return false;
+
+        file << "# Puzzle solver checkpoint\n";
+        file << "version=" << CHECKPOINT_VERSION << "\n";
+        file << "mode=" << (mode == RESUMABLE_COUNT_SOLUTIONS ? "count" : "first") << "\n";
+        // 图块定义的指纹：每种图块的id和放置数，恢复时用来确认放置表的编号没有变化
+        file << "pieces=";
+        for (size_t t = 0; t < table.pieces.size(); t++) {
+            file << (t ? " " : "") << table.pieces[t].id << ":" << table.placements[t].size();
+        }
+        file << "\n";
+        // 被挡住的格子（十六进制掩码），恢复时必须与当前棋盘形状相同
+        file << "blocked=" << hex << table.blocked << dec << "\n";
+        file << "counts=";
+        for (size_t i = 0; i < counts.size(); i++) {
+            file << (i ? " " : "") << counts[i].pieceId << ":" << counts[i].count;
+        }
+        file << "\n";
+        file << "nodes=" << nodes << "\n";
+        file << "solutions=" << solutions << "\n";
+        // 每层一行：typeSlot candidate placed
+        for (const auto& frame : stack) {
+            file << "frame=" << frame.typeSlot << " " << frame.candidate << " " << (frame.placed ? 1 : 0) << "\n";
+        }
+        file.close();
+        if (file.fail()) return false;
+    }
+    // 先写完临时文件再一步替换：写入或替换中途退出时，检查点要么是旧的，要么是新的
+    return replaceFile(tempPath, path);
+}
+
+bool ResumableSolver::loadCheckpoint(const string& path) {
+    ifstream file(path);
+    if (!file.is_open()) return false;
+
+    int version = 0;
+    string modeName, pieceList, countList, blockedMask;
+    long long savedNodes = 0, savedSolutions = 0;
+    vector<Frame> frames;
+
+    string line;
+    try {
+        while (getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            size_t pos = line.find('=');
+            if (pos == string::npos) return false;
+            string key = line.substr(0, pos);
+            string value = line.substr(pos + 1);
+
+            if (key == "version") version = stoi(value);
+            else if (key == "mode") modeName = value;
+            else if (key == "pieces") pieceList = value;
+            else if (key == "blocked") blockedMask = value;
+            else if (key == "counts") countList = value;
+            else if (key == "nodes") savedNodes = stoll(value);
+            else if (key == "solutions") savedSolutions = stoll(value);
+            else if (key == "frame") {
+                Frame frame = {0, 0, -1, false};
+                int placed = 0;
+                istringstream iss(value);
+                if (!(iss >> frame.typeSlot >> frame.candidate >> placed)) return false;
+                frame.placed = placed != 0;
+                frames.push_back(frame);
+            }
+        }
+    } catch (const exception&) {
+        // stoi/stoll遇到损坏的数字
+        return false;
+    }
+    if (version != CHECKPOINT_VERSION) return false;
+    if (modeName != "first" && modeName != "count") return false;
+
+    ostringstream expected;
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        expected << (t ? " " : "") << table.pieces[t].id << ":" << table.placements[t].size();
+    }
+    if (pieceList != expected.str()) return false;
+    ostringstream expectedBlocked;
+    expectedBlocked << hex << table.blocked;
+    if (blockedMask != expectedBlocked.str()) return false;
+
+    vector<PieceCount> savedCounts;
+    istringstream countStream(countList);
+    string item;
+    while (countStream >> item) {
+        PieceCount pc = {0, 0, 0};
+        char colon = 0;
+        istringstream itemStream(item);
+        if (!(itemStream >> pc.pieceId >> colon >> pc.count) || colon != ':') return false;
+        savedCounts.push_back(pc);
+    }
+
+    // 从初始局面开始按栈重放放置，同时校验每一层都合法
+    ResumableMode savedMode = (modeName == "count") ? RESUMABLE_COUNT_SOLUTIONS : RESUMABLE_FIRST_SOLUTION;
+    if (!start(savedCounts, savedMode)) {
+        // 不可能有解的实例：检查点中应该是空栈
+        if (!frames.empty()) return false;
+        stack.clear();
+    } else {
+        stack.clear();
+        for (size_t d = 0; d < frames.size(); d++) {
+            Frame frame = frames[d];
+            // 棋盘已经铺满时不会再压入新的一层：还有剩余的层说明文件被改坏
+            if (occupied == FULL_BOARD_MASK) return false;
+            frame.cell = lowestBitIndex(~occupied);
+            // 只有栈顶可以处于未放置状态，其余各层的放置正是下一层局面的来源
+            if (!frame.placed && d + 1 != frames.size()) return false;
+            if (frame.typeSlot < 0 || frame.typeSlot >= (int)typeOrder.size()) return false;
+            int type = frameType(frame);
+            if (type < 0 || type >= (int)table.placements.size()) return false;
+            const auto& list = table.anchored[frame.cell][type];
+            if (frame.candidate < -1 || frame.candidate >= (int)list.size()) return false;
+            if (frame.candidate >= 0 && list[frame.candidate] >= (int)table.placements[type].size()) return false;
+            if (frame.placed) {
+                if (frame.candidate < 0 || remaining[type] <= 0 || (frameMask(frame) & occupied)) return false;
+                frame.placed = false;
+                placeFrame(frame);
+            }
+            stack.push_back(frame);
+        }
+    }
+    nodes = savedNodes;
+    solutions = savedSolutions;
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "puzzle_solver.h"
+
+// 可恢复的求解器：不使用递归，整个搜索状态是一个显式的栈，每层只记录当前尝试到的放置
+// （图块在固定顺序中的位置 + 该图块在以最低空格为最低格的放置中的位置），
+// 棋盘和剩余图块都可以由栈重放得到，所以状态可以写入检查点文件，之后（或在另一台机器上）继续搜索
+// 按最低空格分支，每层检查空区域面积和染色奇偶性
+enum ResumableMode {
+    RESUMABLE_FIRST_SOLUTION,  // 找到解时暂停（再次run()继续找下一个解）
+    RESUMABLE_COUNT_SOLUTIONS  // 统计所有解
+};
+
+enum SearchStatus {
+    SEARCH_FOUND,      // 找到一个解（仅RESUMABLE_FIRST_SOLUTION）
+    SEARCH_EXHAUSTED,  // 整棵树已经搜索完
+    SEARCH_PAUSED      // 到达时间限制或被取消，可以继续run()或保存检查点
+};
+
+class ResumableSolver {
+public:
+    explicit ResumableSolver(const PlacementTable& table);
+
+    // 开始新的搜索；面积或染色奇偶性不满足时返回false，之后的run()直接返回SEARCH_EXHAUSTED
+    bool start(const std::vector<PieceCount>& counts, ResumableMode mode);
+
+    // cancel被置为true后run()尽快暂停（每1024个节点检查一次），状态保留，之后可以继续
+    void setCancelFlag(const std::atomic<bool>* cancel) { cancelFlag = cancel; }
+
+    // 继续搜索，timeLimitSeconds <= 0 表示不限时
+    // checkpointPath非空时每隔checkpointIntervalSeconds秒以及暂停时写一次检查点
+    SearchStatus run(double timeLimitSeconds, const std::string& checkpointPath = std::string(),
+                     double checkpointIntervalSeconds = 60.0);
+
+    // 检查点为文本文件；写入时先写临时文件再一步替换（replaceFile），中途崩溃不会损坏或删除已有的检查点
+    bool saveCheckpoint(const std::string& path) const;
+    // 检查点中的图块定义与放置表不一致（例如图块形状改过）时返回false
+    bool loadCheckpoint(const std::string& path);
+
+    ResumableMode searchMode() const { return mode; }
+    const std::vector<PieceCount>& pieceCounts() const { return counts; }
+    long long nodeCount() const { return nodes; }
+    long long solutionCount() const { return solutions; }
+    int depth() const { return (int)stack.size(); }
+    // 解的棋盘（单元格为pieceId，0为空），仅在run()返回SEARCH_FOUND后有效
+    const std::vector<std::vector<int>>& solution() const { return solutionBoard; }
+
+private:
+    struct Frame {
+        int cell;       // 该层要覆盖的最低空格
+        int typeSlot;   // 当前图块在typeOrder中的位置
+        int candidate;  // 当前放置在anchored[cell][type]中的位置（-1表示还没有开始）
+        bool placed;    // 当前放置是否已经放到棋盘上
+    };
+
+    void reset();
+    bool advance(Frame& frame);
+    int frameType(const Frame& frame) const { return typeOrder[frame.typeSlot]; }
+    BoardMask frameMask(const Frame& frame) const;
+    void placeFrame(Frame& frame);
+    void unplaceFrame(Frame& frame);
+    void pushFrame();
+    void buildSolution();
+
+    const PlacementTable& table;
+    std::vector<int> typeOrder;  // 固定的图块尝试顺序（格子数多的优先），与局面无关，恢复时不需要重算
+    std::vector<PieceCount> counts;
+    ResumableMode mode;
+    std::vector<int> remaining;
+    ParityInfo parity;
+    BoardMask occupied;
+    std::vector<Frame> stack;
+    long long nodes;
+    long long solutions;
+    const std::atomic<bool>* cancelFlag;
+    std::vector<std::vector<int>> solutionBoard;
+};
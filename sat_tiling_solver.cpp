@@ -0,0 +1,192 @@
+#include "sat_tiling_solver.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// 候选数不超过该值时用两两互斥子句表示"至多一个"，否则用顺序编码（子句数线性）
+const int PAIRWISE_AT_MOST_ONE = 6;
+
+}  // namespace
+
+SatTilingSolver::SatTilingSolver(const PlacementTable& table)
+    : table(table), timeout(false), cancelRequested(false), unsatisfiable(false), cancelFlag(nullptr),
+      variables(0), clauses(0) {
+    solutionBoard.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, 0));
+}
+
+void SatTilingSolver::addAtMostOne(CdclSolver& sat, const vector<int>& vars) {
+    int n = (int)vars.size();
+    if (n <= PAIRWISE_AT_MOST_ONE) {
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                sat.addClause({negativeLiteral(vars[i]), negativeLiteral(vars[j])});
+            }
+        }
+        return;
+    }
+
+    // 顺序编码：prefix[i]为真表示前i+1个变量中已有一个为真
+    vector<int> prefix(n - 1);
+    for (int i = 0; i < n - 1; i++) {
+        prefix[i] = sat.newVar();
+    }
+    sat.addClause({negativeLiteral(vars[0]), positiveLiteral(prefix[0])});
+    for (int i = 1; i < n - 1; i++) {
+        sat.addClause({negativeLiteral(vars[i]), positiveLiteral(prefix[i])});
+        sat.addClause({negativeLiteral(prefix[i - 1]), positiveLiteral(prefix[i])});
+        sat.addClause({negativeLiteral(vars[i]), negativeLiteral(prefix[i - 1])});
+    }
+    sat.addClause({negativeLiteral(vars[n - 1]), negativeLiteral(prefix[n - 2])});
+}
+
+void SatTilingSolver::addExactly(CdclSolver& sat, const vector<int>& vars, int k) {
+    int n = (int)vars.size();
+    if (k > n) {
+        sat.addClause({});
+        return;
+    }
+
+    // 顺序计数器：count[i][j-1]为真当且仅当前i+1个变量中至少有j个为真（j = 1..k+1），
+    // 两个方向都编码，计数在每个前缀上都能双向传播
+    int width = k + 1;
+    vector<vector<int>> count(n, vector<int>(width, -1));
+    for (int i = 0; i < n; i++) {
+        for (int j = 1; j <= width && j <= i + 1; j++) {
+            int var = sat.newVar();
+            count[i][j - 1] = var;
+            int x = vars[i];
+            int previous = (i > 0 && j <= i) ? count[i - 1][j - 1] : -1;         // 前i个中至少j个
+            int previousLess = (i > 0 && j > 1) ? count[i - 1][j - 2] : -1;      // 前i个中至少j-1个
+
+            // previous -> var；(previousLess且x) -> var
+            if (previous >= 0) {
+                sat.addClause({negativeLiteral(previous), positiveLiteral(var)});
+            }
+            if (j == 1) {
+                sat.addClause({negativeLiteral(x), positiveLiteral(var)});
+            } else if (previousLess >= 0) {
+                sat.addClause({negativeLiteral(previousLess), negativeLiteral(x), positiveLiteral(var)});
+            }
+
+            // var -> previous或x；var -> previous或previousLess
+            vector<SatLiteral> needX = {negativeLiteral(var), positiveLiteral(x)};
+            if (previous >= 0) needX.push_back(positiveLiteral(previous));
+            sat.addClause(needX);
+            if (j > 1) {
+                vector<SatLiteral> needLess = {negativeLiteral(var)};
+                if (previous >= 0) needLess.push_back(positiveLiteral(previous));
+                if (previousLess >= 0) needLess.push_back(positiveLiteral(previousLess));
+                sat.addClause(needLess);
+            }
+        }
+    }
+
+    sat.addClause({positiveLiteral(count[n - 1][k - 1])});
+    if (k + 1 <= n) {
+        sat.addClause({negativeLiteral(count[n - 1][k])});
+    }
+}
+
+bool SatTilingSolver::solve(const vector<PieceCount>& counts, double timeLimitSeconds) {
+    timeout = false;
+    cancelRequested = false;
+    unsatisfiable = false;
+    variables = 0;
+    clauses = 0;
+    stats = CdclStats();
+
+    vector<int> quotas(table.pieces.size(), 0);
+    int requiredCells = 0;
+    for (const auto& pc : counts) {
+        if (pc.count <= 0) continue;
+        int type = table.typeIndexOf(pc.pieceId);
+        // 未知图块或无法放入棋盘的图块：不可能用满指定数量
+        if (type < 0 || table.placements[type].empty()) {
+            unsatisfiable = true;
+            return false;
+        }
+        quotas[type] += pc.count;
+        requiredCells += pc.count * table.cellCounts[type];
+    }
+    if (requiredCells != table.openCells() ||
+        !parityFeasible(analyzeParity(table, quotas), table.blocked, quotas)) {
+        unsatisfiable = true;
+        return false;
+    }
+
+    CdclSolver sat;
+    sat.setCancelFlag(cancelFlag);
+
+    // placementVar[type][i] = 第i个放置的变量，数量为0的图块没有变量
+    vector<vector<int>> placementVar(table.pieces.size());
+    vector<vector<int>> cellVars(BOARD_CELLS);
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        if (quotas[t] <= 0) continue;
+        for (const auto& placement : table.placements[t]) {
+            int var = sat.newVar();
+            placementVar[t].push_back(var);
+            BoardMask mask = placement.mask;
+            while (mask) {
+                cellVars[lowestBitIndex(mask)].push_back(var);
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    // 每格正好被覆盖一次（面积相等时"至多一次"可由数量推出，但显式写出传播更早）
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        // 被挡住的格子没有放置覆盖，也不需要被覆盖
+        if (table.blocked & (1ULL << cell)) continue;
+        vector<SatLiteral> cover;
+        for (int var : cellVars[cell]) {
+            cover.push_back(positiveLiteral(var));
+        }
+        sat.addClause(cover);
+        addAtMostOne(sat, cellVars[cell]);
+    }
+
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        if (quotas[t] > 0) {
+            addExactly(sat, placementVar[t], quotas[t]);
+        }
+    }
+
+    // 对称性破除：枢轴图块只有一个，任一解都可以经稳定子群中的变换使其落在轨道代表上
+    SymmetryInfo symmetry = analyzeSymmetry(table, quotas);
+    if (symmetry.pivotType >= 0) {
+        const vector<int>& vars = placementVar[symmetry.pivotType];
+        for (size_t i = 0; i < vars.size(); i++) {
+            if (!symmetry.representative[i]) {
+                sat.addClause({negativeLiteral(vars[i])});
+            }
+        }
+    }
+
+    variables = sat.varCount();
+    clauses = sat.clauseCount();
+    SatResult result = sat.solve(timeLimitSeconds);
+    stats = sat.statistics();
+    timeout = sat.timedOut();
+    cancelRequested = sat.cancelled();
+    unsatisfiable = (result == SAT_UNSATISFIABLE);
+    if (result != SAT_SATISFIABLE) return false;
+
+    for (auto& row : solutionBoard) {
+        fill(row.begin(), row.end(), 0);
+    }
+    for (size_t t = 0; t < table.pieces.size(); t++) {
+        for (size_t i = 0; i < placementVar[t].size(); i++) {
+            if (!sat.modelValue(placementVar[t][i])) continue;
+            BoardMask mask = table.placements[t][i].mask;
+            while (mask) {
+                int index = lowestBitIndex(mask);
+                solutionBoard[index / BOARD_SIZE][index % BOARD_SIZE] = table.pieces[t].id;
+                mask &= mask - 1;
+            }
+        }
+    }
+    return true;
+}
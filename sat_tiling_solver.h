@@ -0,0 +1,46 @@
+#pragma once
+
+#include "cdcl_solver.h"
+#include "puzzle_solver.h"
+
+// SAT求解器：把图块组合编码为CNF，用内置的CdclSolver求解
+// 变量：每种数量大于0的图块的每个放置一个变量（为真表示使用该放置）
+// 子句：每个单元格至少被一个放置覆盖、至多被一个放置覆盖（候选多时用顺序编码）；
+//       每种图块正好使用pieceCount个放置（顺序计数器编码）；
+//       对称时枢轴图块（数量为1）只能使用轨道代表放置
+// 学习子句可以证明回溯搜索难以穷举的无解组合
+class SatTilingSolver {
+public:
+    explicit SatTilingSolver(const PlacementTable& table);
+
+    // counts按pieceId匹配放置表中的图块类型；timeLimitSeconds <= 0 表示不限时
+    bool solve(const std::vector<PieceCount>& counts, double timeLimitSeconds);
+
+    // cancel被置为true后求解尽快停止（每256次冲突、1024次决策检查一次）
+    void setCancelFlag(const std::atomic<bool>* cancel) { cancelFlag = cancel; }
+
+    bool timedOut() const { return timeout; }
+    bool cancelled() const { return cancelRequested; }
+    // solve()返回false且没有超时或被取消时，是否已证明无解（包括面积和染色奇偶性检查）
+    bool provedUnsatisfiable() const { return unsatisfiable; }
+    long long nodeCount() const { return stats.decisions; }
+    int variableCount() const { return variables; }
+    int clauseCount() const { return clauses; }
+    const CdclStats& satStatistics() const { return stats; }
+    // 解的棋盘（单元格为pieceId，0为空），仅在solve()返回true后有效
+    const std::vector<std::vector<int>>& solution() const { return solutionBoard; }
+
+private:
+    void addAtMostOne(CdclSolver& sat, const std::vector<int>& vars);
+    void addExactly(CdclSolver& sat, const std::vector<int>& vars, int k);
+
+    const PlacementTable& table;
+    bool timeout;
+    bool cancelRequested;
+    bool unsatisfiable;
+    const std::atomic<bool>* cancelFlag;
+    int variables;
+    int clauses;
+    CdclStats stats;
+    std::vector<std::vector<int>> solutionBoard;
+};
@@ -0,0 +1,263 @@
+#include "solution_cache.h"
+
+#include "replace_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+const int CACHE_VERSION = 1;
+
+// 图块形状的指纹：各方向的格子排序后（方向的顺序也排序）做FNV-1a散列，与形状的定义顺序无关
+uint64_t shapeFingerprint(const SolverPiece& piece) {
+    vector<vector<pair<int, int>>> shapes = piece.shapes;
+    for (auto& shape : shapes) {
+        sort(shape.begin(), shape.end());
+    }
+    sort(shapes.begin(), shapes.end());
+
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](int value) {
+        for (int i = 0; i < 4; i++) {
+            hash ^= (uint64_t)((value >> (i * 8)) & 0xff);
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (const auto& shape : shapes) {
+        mix((int)shape.size());
+        for (const auto& cell : shape) {
+            mix(cell.first);
+            mix(cell.second);
+        }
+    }
+    return hash;
+}
+
+// 规范化的数量向量：pieceId -> 数量（合并重复，去掉数量不大于0的）；有未知图块时返回false
+bool canonicalCounts(const vector<SolverPiece>& pieces, const vector<PieceCount>& counts,
+                     map<int, pair<int, const SolverPiece*>>& canonical) {
+    for (const auto& pc : counts) {
+        if (pc.count <= 0) continue;
+        const SolverPiece* piece = nullptr;
+        for (const auto& candidate : pieces) {
+            if (candidate.id == pc.pieceId) piece = &candidate;
+        }
+        if (piece == nullptr || piece->shapes.empty()) return false;
+        auto& entry = canonical[pc.pieceId];
+        entry.first += pc.count;
+        entry.second = piece;
+    }
+    return true;
+}
+
+// 缓存键："尺寸|被挡住的格子（十六进制）|id:数量@形状指纹,..."
+bool makeKey(const map<int, pair<int, const SolverPiece*>>& canonical, int boardSize, BoardMask blocked,
+             string& key) {
+    ostringstream oss;
+    oss << boardSize << '|' << hex << blocked << '|';
+    bool first = true;
+    for (const auto& item : canonical) {
+        oss << (first ? "" : ",") << dec << item.first << ':' << item.second.first << '@' << hex
+            << shapeFingerprint(*item.second.second);
+        first = false;
+    }
+    key = oss.str();
+    return !first;
+}
+
+// 缓存的解是否正好用canonical中的图块铺满棋盘上未被挡住的格子（防止缓存文件被改坏后给出错误的解）
+bool gridMatches(const vector<vector<int>>& grid, const map<int, pair<int, const SolverPiece*>>& canonical,
+                 int boardSize, BoardMask blocked) {
+    if ((int)grid.size() != boardSize) return false;
+    map<int, int> cells;
+    for (int row = 0; row < boardSize; row++) {
+        if ((int)grid[row].size() != boardSize) return false;
+        for (int col = 0; col < boardSize; col++) {
+            bool isBlocked = boardSize == BOARD_SIZE && (blocked & cellBit(row, col));
+            if ((grid[row][col] == 0) != isBlocked) return false;
+            if (!isBlocked) cells[grid[row][col]]++;
+        }
+    }
+    if (cells.size() != canonical.size()) return false;
+    for (const auto& item : canonical) {
+        auto it = cells.find(item.first);
+        if (it == cells.end()) return false;
+        if (it->second != item.second.first * (int)item.second.second->shapes[0].size()) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+SolutionCache::SolutionCache(const string& path, size_t maxEntries)
+    : path(path), maxEntries(max<size_t>(1, maxEntries)), dirty(false) {}
+
+void SolutionCache::load() {
+    lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    dirty = false;
+
+    ifstream file(path);
+    if (!file.is_open()) return;
+
+    // 文件中最近用到的在前，按文件顺序追加到末尾即保持原来的顺序
+    string line;
+    int version = 0;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        if (line.compare(0, 8, "version=") == 0) {
+            version = atoi(line.c_str() + 8);
+            continue;
+        }
+        if (version != CACHE_VERSION || line.compare(0, 6, "entry=") != 0) continue;
+
+        // entry=键\t结果\t节点数\t耗时\t引擎\t解
+        vector<string> fields;
+        istringstream iss(line.substr(6));
+        string field;
+        while (getline(iss, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 6 || (fields[1] != "sat" && fields[1] != "unsat")) continue;
+
+        CachedSolve result;
+        result.solvable = (fields[1] == "sat");
+        try {
+            result.nodes = stoll(fields[2]);
+            result.seconds = stod(fields[3]);
+        } catch (const exception&) {
+            // 损坏的数字：跳过这一行
+            continue;
+        }
+        result.engine = fields[4];
+        if (result.solvable && !decodeSolutionGrid(fields[5], result.grid)) continue;
+        if (index.count(fields[0]) || entries.size() >= maxEntries) continue;
+        entries.push_back({fields[0], result});
+        index[fields[0]] = prev(entries.end());
+    }
+}
+
+bool SolutionCache::save() {
+    lock_guard<std::mutex> lock(mutex);
+    if (!dirty) return true;
+
+    string tempPath = path + ".tmp";
+    {
+        ofstream file(tempPath);
+        if (!file.is_open()) return false;
+
+        file << "# Puzzle solution cache\n";
+        file << "version=" << CACHE_VERSION << "\n";
+        for (const auto& entry : entries) {
+            const CachedSolve& result = entry.second;
+            file << "entry=" << entry.first << '\t' << (result.solvable ? "sat" : "unsat") << '\t' << result.nodes
+                 << '\t' << result.seconds << '\t' << result.engine << '\t'
+                 << (result.solvable ? encodeSolutionGrid(result.grid) : "-") << "\n";
+        }
+        file.close();
+        if (file.fail()) return false;
+    }
+    // 先写完临时文件再一步替换：写入或替换中途退出时，正式文件要么是旧的缓存，要么是新的缓存
+    if (!replaceFile(tempPath, path)) return false;
+    dirty = false;
+    return true;
+}
+
+bool SolutionCache::lookup(const vector<SolverPiece>& pieces, int boardSize, BoardMask blocked,
+                           const vector<PieceCount>& counts, CachedSolve& result) {
+    map<int, pair<int, const SolverPiece*>> canonical;
+    string key;
+    if (!canonicalCounts(pieces, counts, canonical) || !makeKey(canonical, boardSize, blocked, key)) return false;
+
+    lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) return false;
+    const CachedSolve& cached = it->second->second;
+    if (cached.solvable && !gridMatches(cached.grid, canonical, boardSize, blocked)) {
+        entries.erase(it->second);
+        index.erase(it);
+        dirty = true;
+        return false;
+    }
+    result = cached;
+    // 移到最前面（最近用到）；顺序的变化不值得单独重写整个文件，下一次有内容修改的保存时一起写入
+    entries.splice(entries.begin(), entries, it->second);
+    return true;
+}
+
+void SolutionCache::store(const vector<SolverPiece>& pieces, int boardSize, BoardMask blocked,
+                          const vector<PieceCount>& counts, const CachedSolve& result) {
+    map<int, pair<int, const SolverPiece*>> canonical;
+    string key;
+    if (!canonicalCounts(pieces, counts, canonical) || !makeKey(canonical, boardSize, blocked, key)) return;
+    if (result.solvable && !gridMatches(result.grid, canonical, boardSize, blocked)) return;
+
+    CachedSolve entry = result;
+    // 引擎名称写在制表符分隔的一行中
+    replace(entry.engine.begin(), entry.engine.end(), '\t', ' ');
+    replace(entry.engine.begin(), entry.engine.end(), '\n', ' ');
+    if (!entry.solvable) entry.grid.clear();
+
+    lock_guard<std::mutex> lock(mutex);
+    insertLocked(key, entry);
+}
+
+void SolutionCache::insertLocked(const string& key, const CachedSolve& result) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front({key, result});
+    index[key] = entries.begin();
+    while (entries.size() > maxEntries) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    dirty = true;
+}
+
+size_t SolutionCache::size() const {
+    lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+string encodeSolutionGrid(const vector<vector<int>>& grid) {
+    const char* digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+    string text;
+    for (size_t row = 0; row < grid.size(); row++) {
+        if (row > 0) text += '/';
+        for (int id : grid[row]) {
+            text += (id == 0) ? '.' : (id > 0 && id < 36 ? digits[id] : '?');
+        }
+    }
+    return text;
+}
+
+bool decodeSolutionGrid(const string& text, vector<vector<int>>& grid) {
+    grid.assign(1, vector<int>());
+    for (char c : text) {
+        if (c == '/') {
+            grid.push_back(vector<int>());
+        } else if (c == '.') {
+            grid.back().push_back(0);
+        } else if (c >= '0' && c <= '9') {
+            grid.back().push_back(c - '0');
+        } else if (c >= 'a' && c <= 'z') {
+            grid.back().push_back(c - 'a' + 10);
+        } else {
+            return false;
+        }
+    }
+    for (const auto& row : grid) {
+        if (row.size() != grid.size()) return false;
+    }
+    return true;
+}
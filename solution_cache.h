@@ -0,0 +1,61 @@
+#pragma once
+
+#include "puzzle_solver.h"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 一组图块数量的已知结果：解（或已证明无解）及当时的求解统计
+struct CachedSolve {
+    bool solvable = false;
+    std::vector<std::vector<int>> grid;  // solvable时的解（单元格为pieceId，0为空或被挡住）
+    long long nodes = 0;                 // 求出该结果时搜索的节点数
+    double seconds = 0.0;                // 求出该结果时的耗时
+    std::string engine;                  // 求出该结果的引擎名称
+};
+
+// 持久化的求解结果缓存（GUI和批量求解工具共用，不依赖SFML）
+// 键由棋盘尺寸、被挡住的格子和规范化的数量向量组成：数量为0的图块不出现，同一图块的数量合并，
+// 按pieceId排序，每种用到的图块附带其形状的指纹，所以图块编辑器修改形状后旧结果自动失效，
+// 修改没有用到的图块不影响缓存
+// 只应存入确定的结果（找到解或穷举证明无解），超时和取消的求解不要存入
+// 所有方法都是线程安全的；超过maxEntries条时淘汰最久没有用到的结果
+class SolutionCache {
+public:
+    explicit SolutionCache(const std::string& path, size_t maxEntries = 10000);
+
+    // 读取缓存文件；文件不存在时为空缓存，版本不符或格式错误的行被忽略
+    void load();
+    // 先写临时文件再一步替换（replaceFile），任何时候退出，缓存文件都是完整的旧版本或新版本
+    // 有新的结果或删除了损坏的结果时才写，命中改变的使用顺序随之一起写入；
+    // 调用方应在store()之后和退出时保存，不要在每次命中后保存
+    bool save();
+
+    // 命中且缓存的解与counts一致（各图块的格子数、被挡住的格子为空）时返回true
+    // 命中只在内存中把该结果移到最前面，不会使下一次save()写文件
+    bool lookup(const std::vector<SolverPiece>& pieces, int boardSize, BoardMask blocked,
+                const std::vector<PieceCount>& counts, CachedSolve& result);
+    void store(const std::vector<SolverPiece>& pieces, int boardSize, BoardMask blocked,
+               const std::vector<PieceCount>& counts, const CachedSolve& result);
+
+    size_t size() const;
+
+private:
+    typedef std::list<std::pair<std::string, CachedSolve>> EntryList;
+
+    void insertLocked(const std::string& key, const CachedSolve& result);
+
+    std::string path;
+    size_t maxEntries;
+    mutable std::mutex mutex;
+    EntryList entries;                                             // 最近用到的在前
+    std::unordered_map<std::string, EntryList::iterator> index;   // 键 -> entries中的位置
+    bool dirty;                                                    // 有内容的修改，需要写文件
+};
+
+// 解的文本编码（批量求解工具的输出和缓存文件共用）：各行用/连接，每格为图块id的36进制数字，0为'.'
+std::string encodeSolutionGrid(const std::vector<std::vector<int>>& grid);
+// 解析encodeSolutionGrid()的结果，格式错误时返回false
+bool decodeSolutionGrid(const std::string& text, std::vector<std::vector<int>>& grid);
@@ -0,0 +1,58 @@
+#include "solve_worker.h"
+
+using namespace std;
+
+SolveWorker::SolveWorker() : cancelFlag(false), pending(0), stopping(false) {
+    worker = thread(&SolveWorker::run, this);
+}
+
+SolveWorker::~SolveWorker() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+        cancelLocked();
+    }
+    queueChanged.notify_all();
+    worker.join();
+}
+
+void SolveWorker::submit(Job job, bool preempt) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (preempt) {
+            cancelLocked();
+        }
+        jobs.push_back(move(job));
+        pending++;
+    }
+    queueChanged.notify_one();
+}
+
+void SolveWorker::cancel() {
+    lock_guard<mutex> lock(queueMutex);
+    cancelLocked();
+}
+
+void SolveWorker::cancelLocked() {
+    pending -= (int)jobs.size();
+    jobs.clear();
+    // 没有任务在运行时置位也无妨：取出下一个任务时会清除
+    cancelFlag = true;
+}
+
+void SolveWorker::run() {
+    while (true) {
+        Job job;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = move(jobs.front());
+            jobs.pop_front();
+            // 与出队在同一个锁内清除：之后的submit()/cancel()置位只会作用于这个任务
+            cancelFlag = false;
+        }
+        job(cancelFlag);
+        pending--;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// 常驻的求解工作线程：按提交顺序执行任务，整个程序只创建一次线程
+// 每个任务收到一个取消标志，求解器在热路径上定期读取（见各求解器的setCancelFlag()）；
+// 提交新任务时取消正在运行的任务并丢弃还在排队的任务，新任务在旧任务退出后立即开始
+class SolveWorker {
+public:
+    typedef std::function<void(const std::atomic<bool>& cancel)> Job;
+
+    SolveWorker();
+    // 取消当前任务并等待工作线程退出
+    ~SolveWorker();
+
+    SolveWorker(const SolveWorker&) = delete;
+    SolveWorker& operator=(const SolveWorker&) = delete;
+
+    // 提交任务；preempt为true时先取消正在运行和排队中的任务
+    void submit(Job job, bool preempt = true);
+    // 取消正在运行的任务并丢弃排队中的任务
+    void cancel();
+    // 有任务正在运行或排队
+    bool busy() const { return pending.load() > 0; }
+
+private:
+    void run();
+    void cancelLocked();
+
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<Job> jobs;           // 由queueMutex保护
+    std::atomic<bool> cancelFlag;   // 当前任务的取消标志，开始新任务时清除
+    std::atomic<int> pending;       // 正在运行和排队中的任务数
+    bool stopping;                  // 由queueMutex保护
+};
@@ -0,0 +1,158 @@
+// 测试：BitboardSolver的搜索过程不做堆分配（由ctest运行，失败时返回1）
+//
+// 替换全局operator new统计分配次数，对几组节点数相差很大的图块组合分别调用start()，
+// 再只统计searchSubtree()（搜索本身）期间的分配：每层的临时数组都在SolverArena中预留，
+// 所以无论搜索了多少个节点，分配次数都应为0
+// start()每次求解按图块组合生成染色约束、对称性和逐格候选表，分配次数只与组合有关，不计入
+
+#include "puzzle_solver.h"
+#include "piece_library.h"
+#include "placement_filter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace std;
+
+namespace {
+
+atomic<long long> allocationCount(0);
+
+}  // namespace
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    void* pointer = malloc(size ? size : 1);
+    if (!pointer) throw bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+namespace {
+
+// 每询问几次就有一次"有线程在等待"的splitter：浅层各深度的分支都会被交出一部分，
+// 用来检查交出子树的路径不在搜索中分配；只计数，不保存路径（保存路径的复制属于splitter自己）
+class CountingSplitter : public SubtreeSplitter {
+public:
+    bool hungry() const override { return ++queries % 5 == 0; }
+    void donate(const SearchPath& path) override {
+        donations++;
+        maxLength = max(maxLength, path.size());
+    }
+    mutable long long queries = 0;
+    long long donations = 0;
+    size_t maxLength = 0;
+};
+
+struct Configuration {
+    const char* name;
+    const char* counts;
+};
+
+struct Mode {
+    const char* name;
+    SolverOptions options;
+};
+
+}  // namespace
+
+int main() {
+    const vector<SolverPiece> pieces = standardPieces();
+    const PlacementTable table = buildPlacementTable();
+    // 候选过滤的实现在第一次使用时自检并选定（只有一次），先在统计之外完成
+    cout << "candidate filter: " << placementFilterName() << "\n";
+
+    // 节点数从十几个到几万个（见benchmark_corpus.txt）
+    const Configuration configurations[] = {
+        {"cross-12", "cross:12 1x1-1:4"},
+        {"case1", "cross:4 1x1-1:44"},
+        {"cross-9", "cross:9 1x1-1:19"},
+        {"line3-z", "line3:9 Z-shape:9 1x1-1:1"},
+    };
+
+    vector<Mode> modes;
+    Mode cell = {"cell", SolverOptions()};
+    cell.options.branching = BRANCH_FIRST_EMPTY;
+    cell.options.breakSymmetry = true;
+    cell.options.pruneRegions = true;
+    cell.options.checkParity = true;
+    cell.options.transpositionMegabytes = 4;
+    modes.push_back(cell);
+    Mode mostConstrained = cell;
+    mostConstrained.name = "most-constrained";
+    mostConstrained.options.branching = BRANCH_MOST_CONSTRAINED;
+    modes.push_back(mostConstrained);
+    Mode piece = {"piece", SolverOptions()};
+    piece.options.breakSymmetry = true;
+    piece.options.orderCopies = true;
+    piece.options.pruneRegions = true;
+    modes.push_back(piece);
+
+    int failures = 0;
+    for (const Mode& mode : modes) {
+        for (int split = 0; split < 2; split++) {
+            BitboardSolver solver(table, mode.options);
+            CountingSplitter splitter;
+            if (split) solver.setSplitter(&splitter, 3);
+
+            for (const Configuration& configuration : configurations) {
+                vector<PieceCount> counts;
+                string error;
+                if (!parsePieceCounts(configuration.counts, pieces, counts, error)) {
+                    cerr << configuration.name << ": " << error << "\n";
+                    return 1;
+                }
+                // 按图块类型分支搜索line3-z要很久，1秒内的节点数已经足够说明问题
+                if (!solver.start(counts, 1.0)) {
+                    cerr << configuration.name << ": rejected before search\n";
+                    failures++;
+                    continue;
+                }
+
+                long long before = allocationCount.load();
+                bool found = solver.searchSubtree(SearchPath());
+                long long allocations = allocationCount.load() - before;
+
+                cout << mode.name << (split ? " +split" : "") << " " << configuration.name << ": "
+                     << (found ? "solved" : "no solution") << ", " << solver.nodeCount() << " nodes, "
+                     << allocations << " allocations" << (solver.timedOut() ? " (time limit)" : "") << "\n";
+                if (allocations != 0) failures++;
+            }
+            if (split) {
+                cout << mode.name << ": " << splitter.donations << " subtrees donated, longest path "
+                     << splitter.maxLength << "\n";
+                if (splitter.donations == 0) {
+                    cerr << mode.name << ": splitter never received a subtree\n";
+                    failures++;
+                }
+            }
+        }
+    }
+
+    if (failures > 0) {
+        cerr << failures << " searches allocated memory\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "solver_engine.h"
+
+using namespace std;
+
+const char* toolEngineName(ToolEngine engine) {
+    switch (engine) {
+        case TOOL_ENGINE_CELL: return "cell";
+        case TOOL_ENGINE_MOST_CONSTRAINED: return "most-constrained";
+        case TOOL_ENGINE_PIECE: return "piece";
+        case TOOL_ENGINE_EXACT_COVER: return "exact-cover";
+        case TOOL_ENGINE_SAT: return "sat";
+        default: return "unknown";
+    }
+}
+
+bool parseToolEngine(const string& name, ToolEngine& engine) {
+    for (int e = 0; e < TOOL_ENGINE_COUNT; e++) {
+        if (name == toolEngineName((ToolEngine)e)) {
+            engine = (ToolEngine)e;
+            return true;
+        }
+    }
+    return false;
+}
+
+SolverOptions toolSolverOptions(ToolEngine engine) {
+    SolverOptions options;
+    if (engine == TOOL_ENGINE_PIECE) {
+        options.breakSymmetry = true;
+        options.orderCopies = true;
+        options.pruneRegions = true;
+        return options;
+    }
+    options.branching = (engine == TOOL_ENGINE_MOST_CONSTRAINED) ? BRANCH_MOST_CONSTRAINED : BRANCH_FIRST_EMPTY;
+    options.breakSymmetry = true;
+    options.pruneRegions = true;
+    options.checkParity = true;
+    options.transpositionMegabytes = 16;
+    return options;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "puzzle_solver.h"
+#include "exact_cover_solver.h"
+#include "sat_tiling_solver.h"
+
+#include <string>
+
+// 命令行工具（puzzle_batch、puzzle_benchmark）共用的引擎选择
+// 各引擎的选项与GUI中同名引擎相同，只是置换表按求解器分配（每个线程一个），取较小的预算
+enum ToolEngine {
+    TOOL_ENGINE_CELL,              // BitboardSolver，按最低空格分支（GUI的默认引擎）
+    TOOL_ENGINE_MOST_CONSTRAINED,  // BitboardSolver，按候选放置最少的空格分支
+    TOOL_ENGINE_PIECE,             // BitboardSolver，按图块类型分支
+    TOOL_ENGINE_EXACT_COVER,       // Dancing Links
+    TOOL_ENGINE_SAT,               // CNF + 内置CDCL求解器
+    TOOL_ENGINE_COUNT
+};
+
+// 命令行中的名称：cell、most-constrained、piece、exact-cover、sat
+const char* toolEngineName(ToolEngine engine);
+bool parseToolEngine(const std::string& name, ToolEngine& engine);
+
+// BitboardSolver引擎的求解选项（其他引擎没有选项）
+SolverOptions toolSolverOptions(ToolEngine engine);
+
+// 构造engine对应的求解器并调用fn(solver)，求解器在fn返回后销毁
+// 各求解器的接口相同：solve()、timedOut()、cancelled()、nodeCount()、solution()
+template <typename Fn>
+void withToolSolver(ToolEngine engine, const PlacementTable& table, Fn fn) {
+    switch (engine) {
+        case TOOL_ENGINE_EXACT_COVER: {
+            ExactCoverSolver solver(table);
+            fn(solver);
+            break;
+        }
+        case TOOL_ENGINE_SAT: {
+            SatTilingSolver solver(table);
+            fn(solver);
+            break;
+        }
+        default: {
+            BitboardSolver solver(table, toolSolverOptions(engine));
+            fn(solver);
+            break;
+        }
+    }
+}
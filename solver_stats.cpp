@@ -0,0 +1,78 @@
+#include "solver_stats.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+string jsonString(const string& text) {
+    string result = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') result += '\\';
+        result += ch;
+    }
+    return result + "\"";
+}
+
+}  // namespace
+
+const char* pruneReasonName(PruneReason reason) {
+    switch (reason) {
+        case PRUNE_AREA: return "area";
+        case PRUNE_REGION: return "region";
+        case PRUNE_PARITY: return "parity";
+        case PRUNE_TRANSPOSITION: return "transposition";
+        case PRUNE_DEAD_CELL: return "deadCell";
+        case PRUNE_TIMEOUT: return "timeout";
+        default: return "";
+    }
+}
+
+void SolverStats::reset(size_t typeCount) {
+    *this = SolverStats();
+    placementsTried.assign(typeCount, 0);
+}
+
+void SolverStats::merge(const SolverStats& other) {
+    nodes += other.nodes;
+    placementTests += other.placementTests;
+    forcedPlacements += other.forcedPlacements;
+    if (placementsTried.size() < other.placementsTried.size()) {
+        placementsTried.resize(other.placementsTried.size(), 0);
+    }
+    for (size_t t = 0; t < other.placementsTried.size(); t++) {
+        placementsTried[t] += other.placementsTried[t];
+    }
+    for (int r = 0; r < PRUNE_REASON_COUNT; r++) {
+        prunes[r] += other.prunes[r];
+    }
+    maxDepth = max(maxDepth, other.maxDepth);
+    seconds = max(seconds, other.seconds);
+}
+
+string SolverStats::toJson(const vector<string>& typeNames) const {
+    ostringstream oss;
+    oss << "{\n";
+    oss << "  \"instrumented\": " << (SOLVER_STATS_ENABLED ? "true" : "false") << ",\n";
+    oss << "  \"nodes\": " << nodes << ",\n";
+    oss << "  \"placementTests\": " << placementTests << ",\n";
+    oss << "  \"forcedPlacements\": " << forcedPlacements << ",\n";
+    oss << "  \"maxDepth\": " << maxDepth << ",\n";
+    oss << "  \"seconds\": " << seconds << ",\n";
+    oss << "  \"nodesPerSecond\": " << (long long)nodesPerSecond() << ",\n";
+    oss << "  \"prunes\": {";
+    for (int r = 0; r < PRUNE_REASON_COUNT; r++) {
+        oss << (r ? ", " : "") << jsonString(pruneReasonName((PruneReason)r)) << ": " << prunes[r];
+    }
+    oss << "},\n";
+    oss << "  \"placementsTried\": {";
+    for (size_t t = 0; t < placementsTried.size(); t++) {
+        string name = t < typeNames.size() ? typeNames[t] : to_string(t);
+        oss << (t ? ", " : "") << jsonString(name) << ": " << placementsTried[t];
+    }
+    oss << "}\n";
+    oss << "}\n";
+    return oss.str();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// 求解器计数器：定义PUZZLE_SOLVER_STATS时才统计（CMake选项PUZZLE_SOLVER_STATS），
+// 未定义时SOLVER_STATS(...)中的语句不参与编译，热路径上没有任何开销
+#ifdef PUZZLE_SOLVER_STATS
+#define SOLVER_STATS_ENABLED 1
+#define SOLVER_STATS(statement) do { statement; } while (0)
+#else
+#define SOLVER_STATS_ENABLED 0
+#define SOLVER_STATS(statement) do {} while (0)
+#endif
+
+// 剪枝原因
+enum PruneReason {
+    PRUNE_AREA,           // 剩余图块面积与空格数不符
+    PRUNE_REGION,         // 某个孤立空区域无法由剩余图块正好铺满
+    PRUNE_PARITY,         // 染色奇偶性不满足
+    PRUNE_TRANSPOSITION,  // 置换表中已知无解
+    PRUNE_DEAD_CELL,      // 某个空格已没有可用的放置（按最少候选格分支时）
+    PRUNE_TIMEOUT,        // 超时或被取消
+    PRUNE_REASON_COUNT
+};
+
+struct SolverStats {
+    long long nodes = 0;
+    long long placementTests = 0;            // 放置测试次数（canPlace调用或放置掩码与棋盘的AND）
+    long long forcedPlacements = 0;          // 只有一个候选放置的空格被直接填上的次数
+    std::vector<long long> placementsTried;  // 每种图块实际放到棋盘上的次数（按图块类型索引）
+    long long prunes[PRUNE_REASON_COUNT] = {};
+    int maxDepth = 0;
+    double seconds = 0.0;
+
+    void reset(size_t typeCount);
+    // 合并另一个求解器（例如并行求解的另一个线程）的计数，耗时取较大者
+    void merge(const SolverStats& other);
+    double nodesPerSecond() const { return seconds > 0.0 ? nodes / seconds : 0.0; }
+    // typeNames[type] = 图块名称，用作placementsTried的键
+    std::string toJson(const std::vector<std::string>& typeNames) const;
+};
+
+const char* pruneReasonName(PruneReason reason);
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "board.h"
+#include "piece_library.h"
+
+// 标准图块在完整的N x N棋盘上的放置表，在编译期由STANDARD_PIECES生成（每个Board<N>一份，放在只读数据中）
+// 运行时只需去掉占用被挡住的格子的放置（见buildPlacementTable()和BoardSolver<N>）
+//
+// 放置按图块、形状、行、列的顺序展开（全局编号），与一个形状只差平移的后续形状（例如2x4的第3、4个方向）
+// 产生的放置完全相同，整个跳过，相当于只保留每个掩码第一次出现的放置
+template <int N>
+struct StandardPlacements {
+    typedef Board<N> Geometry;
+    typedef typename Geometry::Mask Mask;
+
+    static constexpr int TYPES = STANDARD_PIECE_COUNT;
+    static constexpr int CELLS = Geometry::CELLS;
+
+    // 两个形状是否只差一个平移（同一图块的形状内格子互不相同，所以只需检查一个包含于另一个）
+    static constexpr bool sameShape(const StandardShape& a, const StandardShape& b) {
+        if (a.cellCount != b.cellCount) return false;
+        int rowA = a.cells[0].first, colA = a.cells[0].second;
+        int rowB = b.cells[0].first, colB = b.cells[0].second;
+        for (int k = 1; k < a.cellCount; k++) {
+            rowA = a.cells[k].first < rowA ? a.cells[k].first : rowA;
+            colA = a.cells[k].second < colA ? a.cells[k].second : colA;
+            rowB = b.cells[k].first < rowB ? b.cells[k].first : rowB;
+            colB = b.cells[k].second < colB ? b.cells[k].second : colB;
+        }
+        for (int i = 0; i < a.cellCount; i++) {
+            bool found = false;
+            for (int j = 0; j < b.cellCount && !found; j++) {
+                found = a.cells[i].first - rowA == b.cells[j].first - rowB &&
+                        a.cells[i].second - colA == b.cells[j].second - colB;
+            }
+            if (!found) return false;
+        }
+        return true;
+    }
+
+    static constexpr bool repeatedShape(const StandardPiece& piece, int s) {
+        for (int earlier = 0; earlier < s; earlier++) {
+            if (sameShape(piece.shapes[earlier], piece.shapes[s])) return true;
+        }
+        return false;
+    }
+
+    // 形状放在基准点(row, col)时是否整个落在棋盘内；lowest为占用的最低格
+    static constexpr bool fits(const StandardShape& shape, int row, int col, int& lowest) {
+        lowest = CELLS;
+        for (int k = 0; k < shape.cellCount; k++) {
+            int r = row + shape.cells[k].first;
+            int c = col + shape.cells[k].second;
+            if (r < 0 || r >= N || c < 0 || c >= N) return false;
+            lowest = r * N + c < lowest ? r * N + c : lowest;
+        }
+        return true;
+    }
+
+    // 放置总数和所有放置占用的格子总数（决定下面各数组的长度）
+    static constexpr int countPlacements(bool cells) {
+        int total = 0;
+        for (const StandardPiece& piece : STANDARD_PIECES) {
+            for (int s = 0; s < piece.shapeCount; s++) {
+                if (repeatedShape(piece, s)) continue;
+                for (int row = 0; row < N; row++) {
+                    for (int col = 0; col < N; col++) {
+                        int lowest = 0;
+                        if (fits(piece.shapes[s], row, col, lowest)) total += cells ? piece.shapes[s].cellCount : 1;
+                    }
+                }
+            }
+        }
+        return total;
+    }
+
+    static constexpr int COUNT = countPlacements(false);
+    static constexpr int COVER_COUNT = countPlacements(true);
+
+    struct Table {
+        Mask masks[COUNT];
+        int type[COUNT];
+        int shapeIndex[COUNT];
+        int baseRow[COUNT];
+        int baseCol[COUNT];
+        int cellCounts[TYPES];
+        int typeStart[TYPES + 1];        // 图块t的放置为全局编号[typeStart[t], typeStart[t + 1])
+        // 以cell为最低格的放置：anchoredList[anchoredStart[cell] .. anchoredStart[cell + 1])，
+        // 按图块大小降序（大的先放），同样大小的按全局编号
+        int anchoredStart[CELLS + 1];
+        int anchoredList[COUNT];
+        // 占用cell的放置：coveringList[coveringStart[cell] .. coveringStart[cell + 1])，按全局编号
+        int coveringStart[CELLS + 1];
+        int coveringList[COVER_COUNT];
+    };
+
+    static constexpr Table build() {
+        Table table{};
+        int lowestCell[COUNT] = {};
+        int count = 0;
+        for (int t = 0; t < TYPES; t++) {
+            const StandardPiece& piece = STANDARD_PIECES[t];
+            table.cellCounts[t] = piece.shapes[0].cellCount;
+            table.typeStart[t] = count;
+            for (int s = 0; s < piece.shapeCount; s++) {
+                if (repeatedShape(piece, s)) continue;
+                const StandardShape& shape = piece.shapes[s];
+                for (int row = 0; row < N; row++) {
+                    for (int col = 0; col < N; col++) {
+                        int lowest = 0;
+                        if (!fits(shape, row, col, lowest)) continue;
+                        Mask mask = Mask();
+                        for (int k = 0; k < shape.cellCount; k++) {
+                            mask = mask | Geometry::cellBit(row + shape.cells[k].first, col + shape.cells[k].second);
+                        }
+                        table.masks[count] = mask;
+                        table.type[count] = t;
+                        table.shapeIndex[count] = s;
+                        table.baseRow[count] = row;
+                        table.baseCol[count] = col;
+                        lowestCell[count] = lowest;
+                        count++;
+                    }
+                }
+            }
+        }
+        table.typeStart[TYPES] = count;
+
+        // 按格子分组：先数每格的个数，再按前缀和填入
+        int anchoredCount[CELLS] = {};
+        int coveringCount[CELLS] = {};
+        for (int i = 0; i < COUNT; i++) {
+            anchoredCount[lowestCell[i]]++;
+            const StandardShape& shape = STANDARD_PIECES[table.type[i]].shapes[table.shapeIndex[i]];
+            for (int k = 0; k < shape.cellCount; k++) {
+                coveringCount[(table.baseRow[i] + shape.cells[k].first) * N + table.baseCol[i] + shape.cells[k].second]++;
+            }
+        }
+        for (int cell = 0; cell < CELLS; cell++) {
+            table.anchoredStart[cell + 1] = table.anchoredStart[cell] + anchoredCount[cell];
+            table.coveringStart[cell + 1] = table.coveringStart[cell] + coveringCount[cell];
+            anchoredCount[cell] = table.anchoredStart[cell];
+            coveringCount[cell] = table.coveringStart[cell];
+        }
+        for (int size = 9; size >= 1; size--) {
+            for (int i = 0; i < COUNT; i++) {
+                if (table.cellCounts[table.type[i]] == size) table.anchoredList[anchoredCount[lowestCell[i]]++] = i;
+            }
+        }
+        for (int i = 0; i < COUNT; i++) {
+            const StandardShape& shape = STANDARD_PIECES[table.type[i]].shapes[table.shapeIndex[i]];
+            for (int k = 0; k < shape.cellCount; k++) {
+                int cell = (table.baseRow[i] + shape.cells[k].first) * N + table.baseCol[i] + shape.cells[k].second;
+                table.coveringList[coveringCount[cell]++] = i;
+            }
+        }
+        return table;
+    }
+
+    static constexpr Table table = build();
+};